@@ -0,0 +1,230 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event.hpp"
+#include "scoped.hpp"
+
+using namespace std;
+
+/**
+ * Compares the slot based event dispatch against the previous std::list / std::function implementation, which is
+ * reproduced below. Every global allocation is counted to verify that dispatching doesn't allocate.
+ */
+
+static size_t allocations;
+
+void* operator new( size_t size )
+{
+    ++allocations;
+    if ( auto result = malloc( size ) ) {
+        return result;
+    }
+    throw bad_alloc();
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    free( pointer );
+}
+
+void operator delete( void* pointer, size_t ) noexcept
+{
+    free( pointer );
+}
+
+namespace legacy {
+
+    using sc::Scoped;
+
+    class EventConnection
+    {
+        template< typename Signature > friend class EventInterface;
+
+    public:
+        EventConnection() = default;
+
+        void disconnect() const
+        {
+            if ( disconnect_ ) {
+                disconnect_();
+                disconnect_ = nullptr;
+            }
+        }
+
+    private:
+        explicit EventConnection( function< void () > disconnect ) : disconnect_( move( disconnect ) ) {}
+
+        mutable function< void () > disconnect_;
+    };
+
+    template< typename Signature >
+    class EventInterface;
+
+    template< typename ...Args >
+    class EventInterface< void ( Args... ) >
+    {
+        struct Holder
+        {
+            Holder& operator=( function< void ( Args... ) >&& handler ) { this->handler = move( handler ); return *this; }
+
+            function< void ( Args... ) > handler;
+            bool erased {};
+        };
+
+    public:
+        EventConnection subscribe( function< void ( Args... ) > handler )
+        {
+            auto guard = lock();
+            auto it = inserted_.emplace( handlers_.end() );
+            EventConnection connection( [this, it] { erase( it ); } );
+            *it = move( handler );
+            return connection;
+        }
+
+        template< typename ...T >
+        void operator()( T&&... args )
+        {
+            auto guard = lock();
+            for ( auto const& holder : handlers_ ) {
+                if ( !holder.erased ) {
+                    holder.handler( forward< T >( args )... );
+                }
+            }
+        };
+
+    private:
+        Scoped lock()
+        {
+            return Scoped(
+                    [this] { ++locked_; },
+                    [this] {
+                        if ( --locked_ == 0 ) {
+                            handlers_.remove_if( []( Holder& holder ) { return holder.erased; } );
+                            handlers_.splice( handlers_.end(), inserted_ );
+                        }
+                    } );
+        }
+
+        void erase( typename list< Holder >::iterator it )
+        {
+            auto guard = lock();
+            it->erased = true;
+        }
+
+        list< Holder > handlers_;
+        list< Holder > inserted_;
+        size_t locked_ {};
+    };
+
+    template< typename Signature >
+    class Event
+            : public EventInterface< Signature >
+    {
+    };
+
+} // namespace legacy
+
+namespace current {
+
+    template< typename Signature >
+    class Event
+            : public sc::Event< Signature >
+    {
+    public:
+        using sc::Event< Signature >::interface;
+
+        template< typename Function >
+        sc::EventConnection subscribe( Function&& handler )
+        {
+            return interface().subscribe( forward< Function >( handler ) );
+        }
+    };
+
+} // namespace current
+
+struct Result
+{
+    double nanoseconds;
+    double allocations;
+};
+
+template< typename Function >
+static Result measure( size_t iterations, Function&& function )
+{
+    auto startAllocations = allocations;
+    auto start = chrono::steady_clock::now();
+    for ( size_t i = 0 ; i < iterations ; ++i ) {
+        function();
+    }
+    auto elapsed = chrono::steady_clock::now() - start;
+    return {
+            (double) chrono::duration_cast< chrono::nanoseconds >( elapsed ).count() / iterations,
+            (double) ( allocations - startAllocations ) / iterations };
+}
+
+// one dispatch of a poll event to a typical number of subscribers
+template< typename Event >
+static Result dispatch( size_t handlers, size_t iterations )
+{
+    Event event;
+    size_t sum = 0;
+    for ( size_t i = 0 ; i < handlers ; ++i ) {
+        event.subscribe( [&sum]( chrono::nanoseconds elapsed ) { sum += elapsed.count(); } );
+    }
+    auto result = measure( iterations, [&event] { event( chrono::nanoseconds( 1 ) ); } );
+    if ( sum == 0 ) {
+        cerr << "dispatch was optimized away\n";
+    }
+    return result;
+}
+
+// a transition subscribing to the poll event and disconnecting again, as fades do on every change
+template< typename Event >
+static Result churn( size_t handlers, size_t iterations )
+{
+    Event event;
+    size_t sum = 0;
+    for ( size_t i = 0 ; i < handlers ; ++i ) {
+        event.subscribe( [&sum]( chrono::nanoseconds elapsed ) { sum += elapsed.count(); } );
+    }
+    return measure( iterations, [&event, &sum] {
+        auto connection = event.subscribe( [&sum]( chrono::nanoseconds elapsed ) { sum += elapsed.count(); } );
+        event( chrono::nanoseconds( 1 ) );
+        connection.disconnect();
+    } );
+}
+
+static void report( string const& name, Result const& legacy, Result const& current )
+{
+    cout << left << setw( 24 ) << name << right << fixed << setprecision( 1 )
+         << setw( 12 ) << legacy.nanoseconds << setw( 12 ) << current.nanoseconds
+         << setprecision( 2 ) << setw( 14 ) << legacy.allocations << setw( 14 ) << current.allocations << "\n";
+}
+
+int main()
+{
+    static size_t const iterations = 1000000;
+
+    cout << left << setw( 24 ) << "benchmark" << right
+         << setw( 12 ) << "legacy ns" << setw( 12 ) << "slots ns"
+         << setw( 14 ) << "legacy allocs" << setw( 14 ) << "slots allocs" << "\n";
+    for ( size_t handlers : { 1, 16, 128 } ) {
+        report( "dispatch/" + to_string( handlers ),
+                dispatch< legacy::Event< void ( chrono::nanoseconds ) > >( handlers, iterations ),
+                dispatch< current::Event< void ( chrono::nanoseconds ) > >( handlers, iterations ) );
+    }
+    for ( size_t handlers : { 1, 16, 128 } ) {
+        report( "churn/" + to_string( handlers ),
+                churn< legacy::Event< void ( chrono::nanoseconds ) > >( handlers, iterations / 10 ),
+                churn< current::Event< void ( chrono::nanoseconds ) > >( handlers, iterations / 10 ) );
+    }
+}
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <stdexcept>
 #include <utility>
 
@@ -8,6 +9,8 @@
 #include "connection.hpp"
 #include "core/input.hpp"
 #include "core/manager.hpp"
+#include "core/workerpool.hpp"
+#include "fusion.hpp"
 #include "types.hpp"
 
 using namespace std;
@@ -30,13 +33,115 @@ namespace sc {
         return vector< unique_ptr< TransitionInstance > >( first, last );
     }
 
+    /**
+     * class FusedTransitionInstance
+     *
+     * Stands in for a run of adjacent stateless transitions, replacing their passes by a single one.
+     */
+
+    class FusedTransitionInstance final
+            : public TransitionInstance
+    {
+    public:
+        FusedTransitionInstance( Transition const& transition, FusionKernel&& kernel, WorkerPool& workers )
+                : transition_( transition )
+                , kernel_( move( kernel ) )
+                , workers_( workers )
+        {
+        }
+
+        virtual Transition const& transition() const override { return transition_; }
+
+        virtual bool stateless() const override { return true; }
+
+        virtual bool acceptsChannels( size_t channels ) const override { return channels == kernel_.inputChannels(); }
+        virtual size_t emitsChannels( size_t channels ) const override { return kernel_.outputChannels(); }
+
+        virtual void transform( Connection& connection, ChannelBuffer& values ) override
+        {
+            ChannelBuffer output( kernel_.outputChannels() );
+            output.begin(); // expands a compressed buffer before it is written concurrently
+            workers_.parallelFor(
+                    output.size(), WorkerPool::grain, [this, &values, &output]( size_t first, size_t last ) {
+                        kernel_.apply( values, output, first, last );
+                    } );
+            values = move( output );
+        }
+
+        virtual bool fuse( size_t channels, FusionKernel& kernel ) const override { return false; }
+
+        virtual bool concurrent() const override { return true; }
+
+    private:
+        Transition const& transition_;
+        FusionKernel kernel_;
+        WorkerPool& workers_;
+    };
+
+    static vector< string > fuseInstances(
+            vector< unique_ptr< TransitionInstance > >& instances, size_t channels, WorkerPool& workers )
+    {
+        vector< string > fused;
+        vector< unique_ptr< TransitionInstance > > result;
+        auto it = instances.begin();
+        while ( it != instances.end() ) {
+            // extend the run as long as the transitions compose into the kernel
+            FusionKernel kernel( channels );
+            auto last = it;
+            auto emitted = channels;
+            string description;
+            while ( last != instances.end() ) {
+                FusionKernel extended = kernel;
+                if ( !( *last )->fuse( emitted, extended ) ) {
+                    break;
+                }
+                kernel = move( extended );
+                description += ( description.empty() ? "" : "+" ) + ( *last )->transition().id();
+                emitted = ( *last )->emitsChannels( emitted );
+                ++last;
+            }
+
+            if ( distance( it, last ) >= 2 ) {
+                result.emplace_back( new FusedTransitionInstance( ( *it )->transition(), move( kernel ), workers ) );
+                fused.push_back( move( description ) );
+                channels = emitted;
+                it = last;
+            }
+            else {
+                channels = ( *it )->emitsChannels( channels );
+                result.push_back( move( *it++ ) );
+            }
+        }
+        instances = move( result );
+        return fused;
+    }
+
 	static PropertyKey const inputProperty( "input" );
 	static PropertyKey const transitionsProperty( "transitions" );
+	static PropertyKey const updateIntervalProperty( "updateInterval", "0s" );
+	static PropertyKey const priorityProperty( "priority", "normal" );
+
+    static bool parseLowPriority( PropertyNode const& node )
+    {
+        auto priority = node.as< string >();
+        if ( priority != "normal" && priority != "low" ) {
+            throw runtime_error( str( "invalid priority \"", priority, "\" in ", node.path() ) );
+        }
+        return priority == "low";
+    }
 
 	Connection::Connection( string&& id, Manager& manager, PropertyNode const& properties )
             : Component( move( id ) )
             , Output( manager, properties[ inputProperty ] )
+            , scheduler_( manager.scheduler() )
+            , updateInterval_( properties[ updateIntervalProperty ].as< chrono::nanoseconds >() )
+            , lowPriority_( parseLowPriority( properties[ priorityProperty ] ) )
             , instances_( createInstances( *this, manager, properties[ transitionsProperty ] ) )
+            , generation_( 1 )
+            , evaluatedGeneration_()
+            , prefixGeneration_()
+            , prefixHits_()
+            , rendered_()
 	{
         // TODO
         Transition const* sender = nullptr;
@@ -48,6 +153,13 @@ namespace sc {
             sender = &instance->transition();
             channels_ = instance->emitsChannels( channels_ );
         }
+
+        // the channel counts are known to be consistent now, so runs of stateless transitions can be fused
+        fused_ = fuseInstances( instances_, inputs().front()->emitsChannels(), manager.workers() );
+        statelessPrefix_ = (size_t) distance(
+                instances_.cbegin(),
+                find_if( instances_.cbegin(), instances_.cend(),
+                         []( unique_ptr< TransitionInstance > const& instance ) { return !instance->stateless(); } ) );
 	}
 
     bool Connection::acceptsChannels( size_t channels ) const
@@ -55,26 +167,96 @@ namespace sc {
         return !instances_.empty() ? instances_.front()->acceptsChannels( channels ) : true;
     }
 
-	void Connection::transfer()
+    void Connection::transfer()
+    {
+        scheduler_.schedule( *this );
+    }
+
+    bool Connection::concurrent() const
+    {
+        // a new input may make transitions subscribe to or unsubscribe from the poll event
+        if ( generation_ != evaluatedGeneration_ ) {
+            return false;
+        }
+
+        // behind the first stateful transition the input of the transitions may change with every evaluation
+        bool stateful = false;
+        for ( auto const& instance : instances_ ) {
+            if ( !instance->concurrent() || ( stateful && !instance->stateless() ) ) {
+                return false;
+            }
+            stateful = stateful || !instance->stateless();
+        }
+        return true;
+    }
+
+    void Connection::render()
 	{
-        output_ = input_;
-        for_each(
-                instances_.cbegin(), instances_.cend(),
-                [this]( unique_ptr< TransitionInstance > const& instance ) {
-                    instance->transform( *this, output_ );
-                } );
-        inputChangeEvent_( output_ );
+        auto transform = [this]( unique_ptr< TransitionInstance > const& instance ) {
+            instance->transform( *this, output_ );
+        };
+
+        // the stateless transitions at the front of the chain only need to run again if the input changed
+        auto suffix = next( instances_.cbegin(), statelessPrefix_ );
+        if ( statelessPrefix_ == 0 ) {
+            output_ = input_;
+        }
+        else if ( prefixGeneration_ != generation_ ) {
+            output_ = input_;
+            for_each( instances_.cbegin(), suffix, transform );
+            prefix_ = output_;
+            prefixGeneration_ = generation_;
+        }
+        else {
+            output_ = prefix_;
+            ++prefixHits_;
+        }
+        for_each( suffix, instances_.cend(), transform );
+        rendered_ = true;
 	}
 
+    void Connection::evaluate()
+    {
+        if ( !rendered_ ) {
+            render();
+        }
+        rendered_ = false;
+        evaluatedGeneration_ = generation_;
+        inputChangeEvent_( output_ );
+    }
+
     void Connection::set( Input const& input, ChannelBuffer const& values )
     {
+        // changes from outside a pass must not overwrite a pending one, changes within a pass are coalesced
+        if ( scheduler_.scheduled( *this ) && !scheduler_.flushing() ) {
+            scheduler_.evaluate( *this );
+        }
+
         input_ = values;
+        ++generation_;
         transfer();
     }
 
     void Connection::doStatistics( ostream& os ) const
     {
-        os << "\n\t\tinput: " << makeStatistics( input_ )
+        if ( updateInterval_ != chrono::nanoseconds::zero() ) {
+            os << ", interval: " << chrono::duration_cast< chrono::milliseconds >( updateInterval_ ).count() << "ms";
+        }
+        if ( lowPriority_ ) {
+            os << ", low priority";
+        }
+        os << ", cached: " << statelessPrefix_ << "/" << instances_.size() << ", hits: " << prefixHits_
+           << ", cost: " << chrono::duration_cast< chrono::microseconds >( cost() ).count() << "us, worst: "
+           << chrono::duration_cast< chrono::microseconds >( worstCost() ).count() << "us, overruns: " << overruns();
+        if ( !fused_.empty() ) {
+            os << ", fused: [";
+            for ( auto it = fused_.cbegin() ; it != fused_.cend() ; ++it ) {
+                os << ( it != fused_.cbegin() ? ", " : "" ) << *it;
+            }
+            os << "]";
+        }
+        os
+           << "\n\t\tinput: " << makeStatistics( input_ )
            << "\n\t\toutput: " << makeStatistics( output_ );
     }
 
@@ -1,12 +1,14 @@
 #ifndef SCHLAZICONTROL_CONNECTION_HPP
 #define SCHLAZICONTROL_CONNECTION_HPP
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "core/input.hpp"
 #include "core/output.hpp"
+#include "core/scheduler.hpp"
 #include "transition.hpp"
 #include "types.hpp"
 
@@ -15,28 +17,70 @@ namespace sc {
 	class Manager;
 	class PropertyNode;
 
+	/**
+	 * class Connection
+	 *
+	 * Runs its input through a chain of transitions. Evaluation is left to the scheduler, so any number of input
+	 * changes and transfer requests within one pass result in a single evaluation.
+	 *
+	 * A connection that is only polled, with an input that hasn't changed since the previous evaluation, may be
+	 * rendered on a worker thread if its transitions allow it.
+	 *
+	 * Low priority connections are the first to drop frames when frames exceed their budget, see FrameGovernor.
+	 */
+
 	class Connection final
 		: public Output
         , public Input
+        , public Schedulable
 	{
 	public:
 		Connection( std::string&& id, Manager& manager, PropertyNode const& properties );
 
         bool acceptsChannels( std::size_t channels ) const override;
         std::size_t emitsChannels() const override { return channels_; }
+        std::size_t rank() const override { return inputRank() + 1; }
+
+        /**
+         * Counts the changes of the connection's input
+         */
+        std::size_t generation() const { return generation_; }
+
+        /**
+         * Returns the interval at which polling transitions should update the connection, zero for every frame
+         */
+        std::chrono::nanoseconds updateInterval() const { return updateInterval_; }
 
+        /**
+         * Requests another evaluation of the transitions in the current scheduler pass
+         */
         void transfer();
 
     protected:
         void set( Input const& input, ChannelBuffer const& values ) override;
+        bool concurrent() const override;
+        bool deferrable() const override { return lowPriority_; }
+        void render() override;
+        void evaluate() override;
 
         void doStatistics( std::ostream& os ) const override;
 
 	private:
+        Scheduler& scheduler_;
+        std::chrono::nanoseconds updateInterval_;
+        bool lowPriority_;
 		std::vector< std::unique_ptr< TransitionInstance > > instances_;
+        std::vector< std::string > fused_;
         std::size_t channels_;
+        std::size_t statelessPrefix_;
+        std::size_t generation_;
+        std::size_t evaluatedGeneration_;
+        std::size_t prefixGeneration_;
+        std::size_t prefixHits_;
         ChannelBuffer input_;
+        ChannelBuffer prefix_;
         ChannelBuffer output_;
+        bool rendered_;
 	};
 
 } // namespace sc
@@ -20,6 +20,13 @@ namespace sc {
             case 'p': return "pid-file";
 #if defined( SCHLAZICONTROL_FORK )
 			case 'd': return "daemonize";
+#endif
+#if SCHLAZICONTROL_REALTIME
+			case 's': return "scheduling";
+			case 'a': return "cpu-affinity";
+			case 'S': return "process-scheduling";
+			case 'A': return "process-cpu-affinity";
+			case 'm': return "lock-memory";
 #endif
 			default: throw invalid_argument( str( "cmdLineMapShortToLong( ", shortopt, ")" ) );
 		}
@@ -28,6 +35,7 @@ namespace sc {
 	CommandLine::CommandLine( char* const *argv, int argc )
 		: propertiesFile_( "/etc/schlazicontrol.json" )
 		, daemon_()
+		, lockMemory_()
 	{
 		struct option options[] = {
 			{ nullptr, no_argument,       nullptr, 'h' },
@@ -36,6 +44,13 @@ namespace sc {
             { nullptr, required_argument, nullptr, 'p' },
 #if defined( SCHLAZICONTROL_FORK )
 			{ nullptr, no_argument,       nullptr, 'd' },
+#endif
+#if SCHLAZICONTROL_REALTIME
+			{ nullptr, required_argument, nullptr, 's' },
+			{ nullptr, required_argument, nullptr, 'a' },
+			{ nullptr, required_argument, nullptr, 'S' },
+			{ nullptr, required_argument, nullptr, 'A' },
+			{ nullptr, no_argument,       nullptr, 'm' },
 #endif
 			{}
 		};
@@ -50,7 +65,7 @@ namespace sc {
 
 		int optchar;
 		int optind;
-		while ( ( optchar = getopt_long( argc, argv, ":hc:l:p:d", options, &optind ) ) != -1 ) {
+		while ( ( optchar = getopt_long( argc, argv, ":hc:l:p:ds:a:S:A:m", options, &optind ) ) != -1 ) {
 			switch ( optchar ) {
 				case ':':
 					throw runtime_error( str( "missing argument to --", cmdLineMapShortToLong( optopt ) ) );
@@ -77,6 +92,26 @@ namespace sc {
 					daemon_ = true;
 					break;
 
+				case 's':
+					scheduling_ = optarg;
+					break;
+
+				case 'a':
+					cpuAffinity_ = optarg;
+					break;
+
+				case 'S':
+					processScheduling_ = optarg;
+					break;
+
+				case 'A':
+					processCpuAffinity_ = optarg;
+					break;
+
+				case 'm':
+					lockMemory_ = true;
+					break;
+
 				default:
 					throw invalid_argument( str( "getopt_long( ... ) -> '", optchar, "'" ) );
 			}
@@ -15,11 +15,22 @@ namespace sc {
         std::string const& pidFile() const { return pidFile_; }
         bool daemon() const { return daemon_; }
 
+        std::string const& scheduling() const { return scheduling_; }
+        std::string const& cpuAffinity() const { return cpuAffinity_; }
+        std::string const& processScheduling() const { return processScheduling_; }
+        std::string const& processCpuAffinity() const { return processCpuAffinity_; }
+        bool lockMemory() const { return lockMemory_; }
+
     private:
         std::string propertiesFile_;
         std::string logFile_;
         std::string pidFile_;
         bool daemon_;
+        std::string scheduling_;
+        std::string cpuAffinity_;
+        std::string processScheduling_;
+        std::string processCpuAffinity_;
+        bool lockMemory_;
     };
 
 } // namespace sc
@@ -8,6 +8,12 @@
 #   define SCHLAZICONTROL_FORK 1
 #endif
 
+#if defined( __linux__ )
+#   define SCHLAZICONTROL_REALTIME 1
+#else
+#   define SCHLAZICONTROL_REALTIME 0
+#endif
+
 #define SCHLAZICONTROL_IF( feature, result ) SCHLAZICONTROL_IF_IMPL1( SCHLAZICONTROL_ ## feature, result )
 #define SCHLAZICONTROL_IF_IMPL1( feature, result ) SCHLAZICONTROL_IF_IMPL2( feature, result )
 #define SCHLAZICONTROL_IF_IMPL2( feature, result ) SCHLAZICONTROL_IF_ ## feature ( result )
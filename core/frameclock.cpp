@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <ostream>
+#include <utility>
+
+#include "core/frameclock.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static double toMicroseconds( chrono::nanoseconds value )
+    {
+        return chrono::duration< double, micro >( value ).count();
+    }
+
+    /**
+     * class FrameClock
+     */
+
+    constexpr size_t FrameClock::jitterSamples;
+
+    FrameClock::FrameClock( asio::io_context& service, chrono::nanoseconds interval )
+            : timer_( service )
+            , interval_( interval )
+            , running_()
+            , frames_()
+            , missed_()
+            , suspended_()
+    {
+        jitter_.reserve( jitterSamples );
+    }
+
+    void FrameClock::start( Handler handler )
+    {
+        handler_ = move( handler );
+        resume();
+    }
+
+    void FrameClock::stop()
+    {
+        if ( running_ ) {
+            running_ = false;
+            ++suspended_;
+            timer_.cancel();
+        }
+    }
+
+    void FrameClock::resume()
+    {
+        if ( running_ ) {
+            return;
+        }
+
+        running_ = true;
+        lastTick_ = Clock::now();
+        deadline_ = lastTick_ + interval_;
+        schedule();
+    }
+
+    void FrameClock::statistics( ostream& os ) const
+    {
+        os << "\n\tFrameClock : frames: " << frames_ << ", missed: " << missed_ << ", suspended: " << suspended_
+           << ( running_ ? "" : " (idle)" );
+        if ( jitter_.empty() ) {
+            return;
+        }
+
+        auto samples = jitter_;
+        auto percentile = [&samples]( size_t percent ) {
+            auto it = next( samples.begin(), ( samples.size() - 1 ) * percent / 100 );
+            nth_element( samples.begin(), it, samples.end() );
+            return toMicroseconds( *it );
+        };
+        os << ", jitter: p50: " << percentile( 50 ) << "us, p90: " << percentile( 90 )
+           << "us, p99: " << percentile( 99 ) << "us, max: "
+           << toMicroseconds( *max_element( jitter_.begin(), jitter_.end() ) ) << "us";
+    }
+
+    void FrameClock::schedule()
+    {
+        timer_.expires_at( deadline_ );
+        timer_.async_wait( [this]( asio::error_code ec ) {
+            if ( ec == make_error_code( asio::error::operation_aborted ) || !running_ ) {
+                return;
+            }
+            tick();
+        } );
+    }
+
+    void FrameClock::tick()
+    {
+        auto now = Clock::now();
+        auto elapsed = chrono::duration_cast< chrono::nanoseconds >( now - lastTick_ );
+        auto lateness = chrono::duration_cast< chrono::nanoseconds >( now - deadline_ );
+        lastTick_ = now;
+
+        // the samples form a ring that holds the most recent ticks
+        if ( jitter_.size() < jitterSamples ) {
+            jitter_.push_back( lateness );
+        }
+        else {
+            jitter_[ frames_ % jitterSamples ] = lateness;
+        }
+        ++frames_;
+
+        deadline_ += interval_;
+        if ( deadline_ <= now ) {
+            auto missed = ( now - deadline_ ) / interval_ + 1;
+            missed_ += missed;
+            deadline_ += missed * interval_;
+        }
+
+        handler_( elapsed );
+        if ( running_ ) {
+            schedule();
+        }
+    }
+
+} // namespace sc
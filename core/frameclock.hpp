@@ -0,0 +1,64 @@
+#ifndef SCHLAZICONTROL_FRAMECLOCK_HPP
+#define SCHLAZICONTROL_FRAMECLOCK_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+namespace sc {
+
+    /**
+     * class FrameClock
+     *
+     * Ticks at a fixed rate on absolute deadlines, so the time spent in the handlers doesn't add up to a drift. The
+     * handler receives the time actually elapsed since the previous tick. Deadlines that have already passed when
+     * a tick is handled are skipped and counted as missed frames instead of being caught up in a burst. The clock
+     * can be suspended while there is nothing to do, it then doesn't wake up at all until it is resumed.
+     */
+
+    class FrameClock
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Handler = std::function< void ( std::chrono::nanoseconds elapsed ) >;
+
+        FrameClock( asio::io_context& service, std::chrono::nanoseconds interval );
+
+        bool running() const { return running_; }
+
+        void start( Handler handler );
+        void stop();
+
+        /**
+         * Restarts a stopped clock, the first tick follows one interval later and counts the time from now
+         */
+        void resume();
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        static constexpr std::size_t jitterSamples = 1024;
+
+        void schedule();
+        void tick();
+
+        asio::steady_timer timer_;
+        std::chrono::nanoseconds interval_;
+        Handler handler_;
+        bool running_;
+        Clock::time_point deadline_;
+        Clock::time_point lastTick_;
+        std::size_t frames_;
+        std::size_t missed_;
+        std::size_t suspended_;
+        std::vector< std::chrono::nanoseconds > jitter_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_FRAMECLOCK_HPP
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+#include "core/component.hpp"
+#include "core/framegovernor.hpp"
+#include "core/logging.hpp"
+#include "core/properties.hpp"
+#include "core/ratescheduler.hpp"
+#include "core/scheduler.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static Logger logger( "framegovernor" );
+
+    static constexpr chrono::seconds reportInterval { 1 };
+
+    static double milliseconds( chrono::nanoseconds duration )
+    {
+        return chrono::duration< double, milli >( duration ).count();
+    }
+
+    static char const* describeStep( size_t step )
+    {
+        static char const* const names[] = { "dropping frames of low priority connections",
+                                             "halving the polling rates", "lowering the detail of animations" };
+        return names[ step ];
+    }
+
+    /**
+     * class FrameGovernor
+     */
+
+    static PropertyKey const budgetProperty( "budget", "0s" );
+    static PropertyKey const degradationProperty( "degradation", nlohmann::json::array() );
+    static PropertyKey const escalateAfterProperty( "escalateAfter", 5 );
+    static PropertyKey const recoverAfterProperty( "recoverAfter", 250 );
+
+    vector< FrameGovernor::Step > FrameGovernor::parseDegradation( PropertyNode const& node )
+    {
+        vector< Step > result;
+        for ( auto stepNode : node ) {
+            auto step = stepNode.as< string >();
+            if ( step == "dropLowPriority" ) {
+                result.push_back( Step::dropLowPriority );
+            }
+            else if ( step == "halveRates" ) {
+                result.push_back( Step::halveRates );
+            }
+            else if ( step == "lowerDetail" ) {
+                result.push_back( Step::lowerDetail );
+            }
+            else {
+                throw runtime_error( str( "unknown degradation step \"", step, "\" in ", stepNode.path() ) );
+            }
+        }
+        return result;
+    }
+
+    FrameGovernor::FrameGovernor( PropertyNode const& properties, chrono::nanoseconds interval, Scheduler& scheduler,
+                                  RateScheduler& rateScheduler )
+            : scheduler_( scheduler )
+            , rateScheduler_( rateScheduler )
+            , budget_( properties[ budgetProperty ].as< chrono::nanoseconds >() )
+            , degradation_( parseDegradation( properties[ degradationProperty ] ) )
+            , escalateAfter_( max< size_t >( properties[ escalateAfterProperty ].as< size_t >(), 1 ) )
+            , recoverAfter_( max< size_t >( properties[ recoverAfterProperty ].as< size_t >(), 1 ) )
+            , level_()
+            , coarsening_( 1 )
+            , overrunStreak_()
+            , quietStreak_()
+            , lastReport_()
+            , unreported_()
+            , frames_()
+            , overruns_()
+            , escalations_()
+            , worst_()
+            , total_()
+    {
+        if ( budget_ == chrono::nanoseconds::zero() ) {
+            budget_ = interval;
+        }
+    }
+
+    void FrameGovernor::frame( chrono::nanoseconds duration )
+    {
+        ++frames_;
+        total_ += duration;
+        worst_ = max( worst_, duration );
+
+        if ( duration > budget_ ) {
+            ++overruns_;
+            quietStreak_ = 0;
+            report( duration );
+            if ( ++overrunStreak_ >= escalateAfter_ && level_ < degradation_.size() ) {
+                overrunStreak_ = 0;
+                ++escalations_;
+                logger.warning( "frames keep exceeding the budget of ", milliseconds( budget_ ), "ms, ",
+                                describeStep( (size_t) degradation_[ level_ ] ) );
+                degrade( level_ + 1 );
+            }
+            return;
+        }
+
+        overrunStreak_ = 0;
+
+        // steps back only with some headroom, so that it doesn't toggle at the edge of the budget
+        if ( level_ > 0 && duration * 4 <= budget_ * 3 && ++quietStreak_ >= recoverAfter_ ) {
+            quietStreak_ = 0;
+            logger.info( "frames are within the budget again, no longer ",
+                         describeStep( (size_t) degradation_[ level_ - 1 ] ) );
+            degrade( level_ - 1 );
+        }
+    }
+
+    void FrameGovernor::statistics( ostream& os ) const
+    {
+        os << "\n\tFrameGovernor : budget: " << fixed << setprecision( 1 ) << milliseconds( budget_ )
+           << "ms, frames: " << frames_ << ", overruns: " << overruns_ << ", average: "
+           << ( frames_ != 0 ? milliseconds( total_ ) / frames_ : 0.0 ) << "ms, worst: " << milliseconds( worst_ )
+           << "ms, level: " << level_ << "/" << degradation_.size() << ", escalations: " << escalations_;
+    }
+
+    void FrameGovernor::report( chrono::nanoseconds duration )
+    {
+        auto culprit = scheduler_.costliest();
+        if ( culprit != nullptr ) {
+            scheduler_.blame( *culprit );
+        }
+
+        // one line per report interval, however many frames overran
+        auto now = Clock::now();
+        ++unreported_;
+        if ( now - lastReport_ < reportInterval ) {
+            return;
+        }
+
+        auto component = dynamic_cast< Component const* >( culprit );
+        if ( component != nullptr ) {
+            logger.warning( "frame took ", milliseconds( duration ), "ms of ", milliseconds( budget_ ), "ms, ",
+                            component->describe(), " took ", milliseconds( culprit->cost() ), "ms (", unreported_,
+                            " overruns since the last report)" );
+        }
+        else {
+            logger.warning( "frame took ", milliseconds( duration ), "ms of ", milliseconds( budget_ ),
+                            "ms in polling handlers (", unreported_, " overruns since the last report)" );
+        }
+        lastReport_ = now;
+        unreported_ = 0;
+    }
+
+    void FrameGovernor::degrade( size_t level )
+    {
+        level_ = level;
+
+        size_t drops = 0;
+        size_t halvings = 0;
+        size_t coarsenings = 0;
+        for_each( degradation_.begin(), degradation_.begin() + level_, [&]( Step step ) {
+            switch ( step ) {
+                case Step::dropLowPriority: ++drops; break;
+                case Step::halveRates: ++halvings; break;
+                case Step::lowerDetail: ++coarsenings; break;
+            }
+        } );
+
+        scheduler_.dropping( size_t( 1 ) << drops );
+        rateScheduler_.throttle( halvings );
+        coarsening_ = size_t( 1 ) << coarsenings;
+    }
+
+} // namespace sc
@@ -0,0 +1,82 @@
+#ifndef SCHLAZICONTROL_FRAMEGOVERNOR_HPP
+#define SCHLAZICONTROL_FRAMEGOVERNOR_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace sc {
+
+    class PropertyNode;
+    class RateScheduler;
+    class Scheduler;
+
+    /**
+     * class FrameGovernor
+     *
+     * Times every frame against a budget, by default the update interval, and names the node that took longest in
+     * a frame that overran. If frames overrun several times in a row, the governor takes the next step of its
+     * degradation list, and steps back once frames have stayed well within the budget for a while. The steps are
+     *
+     *  - dropLowPriority: low priority connections are evaluated on every other frame only, once more per step
+     *  - halveRates: all polling handlers run at half their rate, once more per step
+     *  - lowerDetail: animations render at half their resolution, once more per step
+     *
+     * Without a degradation list, overruns are only counted and reported.
+     */
+
+    class FrameGovernor
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        FrameGovernor( PropertyNode const& properties, std::chrono::nanoseconds interval, Scheduler& scheduler,
+                       RateScheduler& rateScheduler );
+        FrameGovernor( FrameGovernor const& ) = delete;
+
+        /**
+         * Returns the factor by which animations reduce their resolution
+         */
+        std::size_t coarsening() const { return coarsening_; }
+
+        void frame( std::chrono::nanoseconds duration );
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        enum class Step
+        {
+            dropLowPriority,
+            halveRates,
+            lowerDetail
+        };
+
+        static std::vector< Step > parseDegradation( PropertyNode const& node );
+
+        void report( std::chrono::nanoseconds duration );
+        void degrade( std::size_t level );
+
+        Scheduler& scheduler_;
+        RateScheduler& rateScheduler_;
+        std::chrono::nanoseconds budget_;
+        std::vector< Step > degradation_;
+        std::size_t escalateAfter_;
+        std::size_t recoverAfter_;
+        std::size_t level_;
+        std::size_t coarsening_;
+        std::size_t overrunStreak_;
+        std::size_t quietStreak_;
+        Clock::time_point lastReport_;
+        std::size_t unreported_;
+        std::size_t frames_;
+        std::size_t overruns_;
+        std::size_t escalations_;
+        std::chrono::nanoseconds worst_;
+        std::chrono::nanoseconds total_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_FRAMEGOVERNOR_HPP
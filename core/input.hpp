@@ -23,6 +23,11 @@ namespace sc {
 
         virtual std::size_t emitsChannels() const = 0;
 
+        /**
+         * Position of the input in the component graph, greater than the rank of everything it depends on
+         */
+        virtual std::size_t rank() const { return 0; }
+
         InputChangeEvent::Interface& inputChangeEvent() { return inputChangeEvent_.interface(); }
 
     protected:
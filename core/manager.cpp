@@ -13,17 +13,20 @@
 #include "core/config.hpp"
 #include "core/component.hpp"
 #include "core/commandline.hpp"
+#include "core/frameclock.hpp"
+#include "core/framegovernor.hpp"
 #include "core/logging.hpp"
+#include "core/ratescheduler.hpp"
+#include "core/realtime.hpp"
+#include "core/renderthread.hpp"
+#include "core/scheduler.hpp"
+#include "core/supervisor.hpp"
+#include "core/timerwheel.hpp"
+#include "core/workerpool.hpp"
 #include "manager.hpp"
 #include "statistics.hpp"
 #include "types.hpp"
 
-#if SCHLAZICONTROL_FORK
-#   include <sys/types.h>
-#   include <sys/wait.h>
-#   include <unistd.h>
-#endif
-
 using namespace std;
 using namespace asio;
 
@@ -31,58 +34,42 @@ namespace sc {
 
     static Logger logger( "manager" );
 
-#if SCHLAZICONTROL_FORK
-	static bool processExited( pid_t pid )
-    {
-	    int status;
-	    auto result = ::waitpid( pid, &status, WNOHANG );
-	    return result == pid || ( result == -1 && errno == ECHILD );
-    }
-
-    static void killGracefully( pid_t pid, size_t timeoutMs = 1000 )
-    {
-        if ( processExited( pid ) ) {
-            return;
-        }
-
-        logger.debug( "terminating process ", pid );
-
-        ::kill( pid, SIGTERM );
-        while ( timeoutMs > 0 ) {
-            int status;
-            if ( ::waitpid( pid, &status, WNOHANG ) == pid ) {
-                return;
-            }
-            this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
-            timeoutMs = timeoutMs > 100 ? timeoutMs - 100 : 0;
-        }
-
-        logger.debug( "termination failed, killing process ", pid );
-
-        ::kill( pid, SIGKILL );
-    }
-#endif
-
     /**
      * struct ManagerInternals
      */
 
     struct ManagerInternals
     {
-        ManagerInternals()
-                : signals( service, SIGINT, SIGTERM )
-                , pollingTimer( service )
+        ManagerInternals( CommandLine const& commandLine, std::chrono::nanoseconds updateInterval, bool renderThread,
+                          size_t workerThreads, PropertyNode const& governorProperties,
+                          PropertyNode const& realtimeProperties, PropertyNode const& processProperties,
+                          function< void () > shutdown )
+                : realtime( commandLine, realtimeProperties )
+                , render( service, renderThread )
+                , signals( service, SIGINT, SIGTERM )
+                , frameClock( render.service(), updateInterval )
+                , rateScheduler( updateInterval )
+                , workers( workerThreads )
+                , scheduler( render.service(), workers )
+                , governor( governorProperties, updateInterval, scheduler, rateScheduler )
+                , timerWheel( render.service() )
                 , statisticsTimer( service )
+                , supervisor( service, realtime, processProperties, move( shutdown ) )
         {
         }
 
+        Realtime realtime;
         asio::io_context service;
+        RenderThread render;
         asio::signal_set signals;
-        asio::steady_timer pollingTimer;
+        FrameClock frameClock;
+        RateScheduler rateScheduler;
+        WorkerPool workers;
+        Scheduler scheduler;
+        FrameGovernor governor;
+        TimerWheel timerWheel;
         asio::steady_timer statisticsTimer;
-#if SCHLAZICONTROL_FORK
-        vector< pid_t > processes;
-#endif
+        Supervisor supervisor;
     };
 
     /**
@@ -116,16 +103,39 @@ namespace sc {
 
     static PropertyKey const updateIntervalProperty( "updateInterval", "40ms" );
     static PropertyKey const statisticsIntervalProperty( "statisticsInterval", "0s" );
+    static PropertyKey const renderThreadProperty( "renderThread", false );
+    static PropertyKey const workerThreadsProperty( "workerThreads", 0 );
+    static PropertyKey const frameGovernorProperty( "frameGovernor", nlohmann::json::object() );
+    static PropertyKey const realtimeProperty( "realtime", nlohmann::json::object() );
+    static PropertyKey const processesProperty( "processes", nlohmann::json::object() );
     static PropertyKey const componentsProperty( "components" );
     static PropertyKey const typeProperty( "type" );
     static PropertyKey const idProperty( "id", "" );
     static PropertyKey const disabledProperty( "disabled", false );
 
+    static size_t parseWorkerThreads( PropertyNode const& node )
+    {
+        if ( node.is< string >() ) {
+            if ( node.as< string >() != "auto" ) {
+                throw runtime_error( str( "invalid worker thread count \"", node.as< string >(), "\" in ",
+                                          node.path() ) );
+            }
+            // the thread that renders works on the chunks as well
+            auto cores = thread::hardware_concurrency();
+            return cores > 1 ? cores - 1 : 0;
+        }
+        return node.as< size_t >();
+    }
+
     Manager::Manager( CommandLine const& cmdLine )
 		: properties_( cmdLine.propertiesFile() )
 		, updateInterval_( properties_[ updateIntervalProperty ].as< std::chrono::nanoseconds >() )
         , statisticsInterval_( properties_[ statisticsIntervalProperty ].as< std::chrono::nanoseconds >() )
-        , internals_( new ManagerInternals )
+        , internals_( new ManagerInternals( cmdLine, updateInterval_, properties_[ renderThreadProperty ].as< bool >(),
+                                            parseWorkerThreads( properties_[ workerThreadsProperty ] ),
+                                            properties_[ frameGovernorProperty ], properties_[ realtimeProperty ],
+                                            properties_[ processesProperty ],
+                                            [this] { stop(); } ) )
     {
         for ( auto componentNode : properties_[ componentsProperty ] ) {
             createComponent( componentNode );
@@ -144,44 +154,67 @@ namespace sc {
         return internals_->service;
     }
 
+    RenderThread& Manager::renderThread()
+    {
+        return internals_->render;
+    }
+
+    Scheduler& Manager::scheduler()
+    {
+        return internals_->scheduler;
+    }
+
+    FrameGovernor& Manager::governor()
+    {
+        return internals_->governor;
+    }
+
+    TimerWheel& Manager::timerWheel()
+    {
+        return internals_->timerWheel;
+    }
+
+    Manager::PollEvent::Interface& Manager::pollEvent( std::chrono::nanoseconds interval )
+    {
+        return internals_->rateScheduler.event( interval );
+    }
+
+    WorkerPool& Manager::workers()
+    {
+        return internals_->workers;
+    }
+
     ManagerProcess Manager::forkProcesses()
     {
 #if SCHLAZICONTROL_FORK
         for ( auto const& entry : components_ ) {
             if ( auto handler = entry.second->forkedProcess() ) {
-                internals_->service.notify_fork( io_service::fork_prepare );
-                auto pid = ::fork();
-                if ( pid == -1 ) {
-                    throw system_error(
-                            errno, std::system_category(), str( "couldn't start process for component ", entry.first ) );
-                }
-                if ( pid == 0 ) {
-                    internals_->service.notify_fork( io_service::fork_child );
+                if ( internals_->supervisor.spawn( *entry.second, handler ) ) {
                     return { *entry.second, move( handler ) };
                 }
-                internals_->service.notify_fork( io_service::fork_parent );
-                internals_->processes.push_back( pid );
             }
         }
+        internals_->supervisor.startLauncher();
 #endif
         return {};
     }
 
     void Manager::run()
     {
+        // before any thread is started, they all inherit the settings
+        internals_->realtime.applyMainLoop();
+        internals_->workers.start();
         readyEvent_();
         startPolling();
         startStatistics();
+        internals_->render.start();
         internals_->service.run();
     }
 
 	void Manager::stop()
     {
-#if SCHLAZICONTROL_FORK
-        for_each( internals_->processes.begin(), internals_->processes.end(),
-                  []( auto pid ) { killGracefully( pid ); } );
-#endif
-
+        internals_->supervisor.terminate();
+        internals_->render.stop();
         internals_->service.stop();
         components_.clear();
     }
@@ -235,16 +268,24 @@ namespace sc {
 
     void Manager::startPolling()
     {
-        internals_->pollingTimer.expires_from_now( updateInterval_ );
-        internals_->pollingTimer.async_wait( [this]( error_code ec ) {
-            if ( ec == make_error_code( asio::error::operation_aborted ) ) {
-                return;
+        internals_->frameClock.start( [this]( std::chrono::nanoseconds elapsed ) {
+            auto start = FrameGovernor::Clock::now();
+            internals_->rateScheduler.tick( elapsed );
+            internals_->scheduler.flush( true );
+            internals_->governor.frame( FrameGovernor::Clock::now() - start );
+
+            // nothing is animating, sleep until something subscribes to the poll event again
+            if ( idle() ) {
+                internals_->frameClock.stop();
             }
-
-			checkProcesses();
-            pollEvent_( updateInterval_ );
-            startPolling();
         } );
+        internals_->rateScheduler.activation( [this] { internals_->frameClock.resume(); } );
+    }
+
+    bool Manager::idle() const
+    {
+        // nodes left for a later frame keep the clock running as well
+        return internals_->rateScheduler.empty() && internals_->scheduler.empty();
     }
 
     void Manager::startStatistics()
@@ -259,20 +300,17 @@ namespace sc {
                 return;
             }
 
-            logger.info( makeStatistics( components_ ), makeStatistics( ChannelBuffer::tracker() ) );
+            // the render thread pauses while the statistics of both sides are collected
+            internals_->render.synchronize( [this] {
+                logger.info( makeStatistics( components_ ), makeStatistics( ChannelBuffer::tracker() ),
+                             makeStatistics( internals_->frameClock ), makeStatistics( internals_->rateScheduler ),
+                             makeStatistics( internals_->render ), makeStatistics( internals_->workers ),
+                             makeStatistics( internals_->scheduler ), makeStatistics( internals_->governor ),
+                             makeStatistics( internals_->timerWheel ), makeStatistics( internals_->supervisor ) );
+            } );
 
             startStatistics();
         } );
     }
 
-    void Manager::checkProcesses()
-    {
-        auto it = find_if( internals_->processes.cbegin(), internals_->processes.cend(),
-                           []( auto pid ) { return processExited( pid ); } );
-        if ( it != internals_->processes.cend() ) {
-            logger.error( "process ", *it, " died unexpectedly, shutting down" );
-            stop();
-        }
-    }
-
 } // namespace sc
@@ -18,6 +18,11 @@ namespace sc {
 
 	class CommandLine;
     class Component;
+    class FrameGovernor;
+    class RenderThread;
+    class Scheduler;
+    class TimerWheel;
+    class WorkerPool;
 
     /**
      * class ManagerProcess
@@ -65,6 +70,11 @@ namespace sc {
         std::chrono::nanoseconds updateInterval() const { return updateInterval_; }
 
 		asio::io_context& service();
+        RenderThread& renderThread();
+        Scheduler& scheduler();
+        FrameGovernor& governor();
+        TimerWheel& timerWheel();
+        WorkerPool& workers();
 
 		template< typename Type >
         Type& get( Component const& requester, PropertyNode const& node )
@@ -78,7 +88,12 @@ namespace sc {
         }
 
         ReadyEvent::Interface& readyEvent() { return readyEvent_.interface(); }
-        PollEvent::Interface& pollEvent() { return pollEvent_.interface(); }
+
+        /**
+         * Returns the poll event for handlers that need to run at least once per interval, by default every frame.
+         * Slower handlers are spread over the frames, see RateScheduler.
+         */
+        PollEvent::Interface& pollEvent( std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero() );
 
         ManagerProcess forkProcesses();
 
@@ -90,8 +105,8 @@ namespace sc {
         void checkValidComponent( Component const& requester, Component const& component, void const* cast ) const;
 
 		void startPolling();
+        bool idle() const;
         void startStatistics();
-        void checkProcesses();
 
         void stop();
 
@@ -101,7 +116,6 @@ namespace sc {
         std::unique_ptr< ManagerInternals > internals_;
         std::unordered_map< std::string, std::unique_ptr< Component > > components_;
 		ReadyEvent readyEvent_;
-		PollEvent pollEvent_;
 	};
 
 } // namespace sc
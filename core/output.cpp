@@ -2,6 +2,7 @@
 #include <utility>
 
 #include "core/input.hpp"
+#include "core/renderthread.hpp"
 #include "manager.hpp"
 #include "core/output.hpp"
 
@@ -18,10 +19,20 @@ namespace sc {
         }
     }
 
+    size_t Output::inputRank() const
+    {
+        size_t result = 0;
+        for ( auto input : inputs_ ) {
+            result = max( result, input->rank() );
+        }
+        return result;
+    }
+
     void Output::initialize( Manager& manager, PropertyNode const& inputsNode, SingleInputTag )
     {
         auto& input = manager.get< Input >( *this, inputsNode );
-        manager.readyEvent().subscribe( [this, &input] { setup( input ); }, true );
+        auto index = inputs_.size();
+        manager.readyEvent().subscribe( [this, &manager, &input, index] { setup( manager, input, index ); }, true );
         inputs_.emplace_back( &input );
     }
 
@@ -32,11 +43,41 @@ namespace sc {
                 [this, &manager]( PropertyNode const& node ) { initialize( manager, node ); } );
     }
 
-    void Output::setup( Input& input )
+    void Output::setup( Manager& manager, Input& input, size_t index )
     {
         auto channels = input.emitsChannels();
         checkConnection( input, *this, channels, acceptsChannels( channels ) );
-        input.inputChangeEvent().subscribe( [this, &input]( ChannelBuffer const& values ) { set( input, values ); } );
+
+        auto& render = manager.renderThread();
+        if ( !render.enabled() ) {
+            input.inputChangeEvent().subscribe( [this, &input, index]( ChannelBuffer const& values ) {
+                setInput( index, input, values );
+            } );
+        }
+        else if ( category() == "output" ) {
+            // outputs do their IO on the main loop, frames from the render thread wait for it in a slot
+            auto& slot = render.slot( [this, &input, index]( ChannelBuffer const& values ) {
+                setInput( index, input, values );
+            } );
+            input.inputChangeEvent().subscribe( [this, &input, index, &render, &slot]( ChannelBuffer const& values ) {
+                if ( render.current() ) {
+                    slot.publish( values );
+                }
+                else {
+                    setInput( index, input, values );
+                }
+            } );
+        }
+        else {
+            input.inputChangeEvent().subscribe( [this, &input, index, &render]( ChannelBuffer const& values ) {
+                if ( render.current() ) {
+                    setInput( index, input, values );
+                }
+                else {
+                    render.post( [this, &input, index, values] { setInput( index, input, values ); } );
+                }
+            } );
+        }
     }
 
 } // namespace sc
\ No newline at end of file
@@ -39,12 +39,21 @@ namespace sc {
     protected:
         virtual void set( Input const& input, ChannelBuffer const& values ) = 0;
 
+        /**
+         * Receives the values of the input at the given index of inputs(), by default without regard to the index
+         */
+        virtual void setInput( std::size_t index, Input const& input, ChannelBuffer const& values )
+        {
+            set( input, values );
+        }
+
         std::vector< Input const* > const& inputs() const { return inputs_; }
+        std::size_t inputRank() const;
 
     private:
         void initialize( Manager& manager, PropertyNode const& inputsNode, SingleInputTag = {} );
         void initialize( Manager& manager, PropertyNode const& inputsNode, MultipleInputsTag );
-        void setup( Input& input );
+        void setup( Manager& manager, Input& input, std::size_t index );
 
         std::vector< Input const* > inputs_;
     };
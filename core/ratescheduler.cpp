@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <utility>
+
+#include "core/ratescheduler.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * class RateScheduler
+     */
+
+    constexpr size_t RateScheduler::maxDivisor;
+
+    RateScheduler::RateScheduler( chrono::nanoseconds interval )
+            : interval_( interval )
+            , shift_()
+            , frame_()
+            , frames_()
+            , dispatched_()
+            , peak_()
+    {
+        // the base rate always exists and comes first, so it runs before the slower groups of the same frame
+        group( 1, 0 );
+    }
+
+    RateScheduler::~RateScheduler() = default;
+
+    bool RateScheduler::empty() const
+    {
+        return all_of( groups_.begin(), groups_.end(), []( auto const& group ) { return group->event.empty(); } );
+    }
+
+    RateScheduler::PollEvent::Interface& RateScheduler::event( chrono::nanoseconds interval )
+    {
+        auto divisor = this->divisor( interval );
+        return group( divisor, divisor > 1 ? phase( divisor ) : 0 ).event.interface();
+    }
+
+    void RateScheduler::tick( chrono::nanoseconds elapsed )
+    {
+        size_t dispatched = 0;
+        // handlers may subscribe to new groups, so don't hold on to iterators
+        for ( size_t i = 0 ; i < groups_.size() ; ++i ) {
+            auto group = groups_[ i ].get();
+            if ( group->event.empty() ) {
+                // nobody to pass the time to, a new subscriber starts counting from its first frame
+                group->elapsed = chrono::nanoseconds::zero();
+                continue;
+            }
+
+            group->elapsed += elapsed;
+            if ( frame_ % group->divisor != group->phase ) {
+                continue;
+            }
+            if ( shift_ != 0 ) {
+                // the groups of a rate take turns on its frames, in the order they were created
+                auto turns = min( size_t( 1 ) << shift_, maxDivisor / group->divisor );
+                if ( frame_ / group->divisor % turns != i % turns ) {
+                    continue;
+                }
+            }
+
+            ++group->ticks;
+            group->dispatched += group->event.size();
+            dispatched += group->event.size();
+            group->event( exchange( group->elapsed, chrono::nanoseconds::zero() ) );
+        }
+
+        frame_ = ( frame_ + 1 ) % maxDivisor;
+        ++frames_;
+        dispatched_ += dispatched;
+        peak_ = max( peak_, dispatched );
+    }
+
+    void RateScheduler::statistics( ostream& os ) const
+    {
+        os << "\n\tRateScheduler : frames: " << frames_ << ", handlers per frame: "
+           << fixed << setprecision( 1 ) << ( frames_ != 0 ? (double) dispatched_ / frames_ : 0.0 )
+           << ", peak: " << peak_ << ", throttle: 1/" << ( size_t( 1 ) << shift_ );
+        for ( auto const& group : groups_ ) {
+            os << "\n\t\t" << chrono::duration_cast< chrono::milliseconds >( interval_ * group->divisor ).count()
+               << "ms/" << group->phase << ": subscribers: " << group->event.size() << ", ticks: " << group->ticks
+               << ", handlers per tick: "
+               << ( group->ticks != 0 ? (double) group->dispatched / group->ticks : 0.0 );
+        }
+    }
+
+    size_t RateScheduler::divisor( chrono::nanoseconds interval ) const
+    {
+        // the largest power of two that doesn't run the group less often than requested
+        size_t divisor = 1;
+        while ( divisor < maxDivisor && interval_ * ( divisor * 2 ) <= interval ) {
+            divisor *= 2;
+        }
+        return divisor;
+    }
+
+    size_t RateScheduler::phase( size_t divisor ) const
+    {
+        // subscribers per frame over one cycle of the slowest possible group
+        array< size_t, maxDivisor > load {};
+        for ( auto const& group : groups_ ) {
+            for ( auto frame = group->phase ; frame < maxDivisor ; frame += group->divisor ) {
+                load[ frame ] += group->event.size();
+            }
+        }
+
+        // the phase whose busiest frame is least busy
+        size_t result = 0;
+        size_t best = numeric_limits< size_t >::max();
+        for ( size_t phase = 0 ; phase < divisor ; ++phase ) {
+            size_t busiest = 0;
+            for ( auto frame = phase ; frame < maxDivisor ; frame += divisor ) {
+                busiest = max( busiest, load[ frame ] );
+            }
+            if ( busiest < best ) {
+                best = busiest;
+                result = phase;
+            }
+        }
+        return result;
+    }
+
+    RateScheduler::Group& RateScheduler::group( size_t divisor, size_t phase )
+    {
+        // a group that has been passing time since it last ran is left to the handlers that have been waiting for it
+        auto it = find_if( groups_.begin(), groups_.end(), [divisor, phase]( auto const& group ) {
+            return group->divisor == divisor && group->phase == phase && group->elapsed == chrono::nanoseconds::zero();
+        } );
+        if ( it != groups_.end() ) {
+            return **it;
+        }
+
+        groups_.emplace_back( new Group { divisor, phase, {}, chrono::nanoseconds::zero(), 0, 0 } );
+        auto& group = *groups_.back();
+        group.event.activation( [this] {
+            if ( activation_ ) {
+                activation_();
+            }
+        } );
+        return group;
+    }
+
+} // namespace sc
@@ -0,0 +1,88 @@
+#ifndef SCHLAZICONTROL_RATESCHEDULER_HPP
+#define SCHLAZICONTROL_RATESCHEDULER_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "event.hpp"
+#include "utility_function.hpp"
+
+namespace sc {
+
+    /**
+     * class RateScheduler
+     *
+     * Distributes the frames of the frame clock to poll events of lower rates. Every rate is the frame rate divided
+     * by a power of two, so all rates stay aligned to each other, and each rate is split into groups that run on
+     * different frames (their phase). Subscribers are added to the group whose frames are least loaded, so work at
+     * lower rates is spread evenly instead of piling up on every n-th frame. Each group passes the time elapsed
+     * since it last ran. A handler that subscribes while that time is adding up joins a group of the same rate and
+     * phase that starts counting when it subscribes, so no handler is passed time from before it subscribed.
+     *
+     * All groups can be throttled to a fraction of their rate, the groups of a rate then take turns on its frames.
+     */
+
+    class RateScheduler
+    {
+    public:
+        using PollEvent = Event< void ( std::chrono::nanoseconds ) >;
+
+        static constexpr std::size_t maxDivisor = 64;
+
+        explicit RateScheduler( std::chrono::nanoseconds interval );
+        RateScheduler( RateScheduler const& ) = delete;
+        ~RateScheduler();
+
+        bool empty() const;
+
+        /**
+         * Sets a handler that is called whenever the first handler subscribes to any of the groups
+         */
+        void activation( InlineFunction< void () > handler ) { activation_ = std::move( handler ); }
+
+        /**
+         * Returns the poll event of the group that runs at least once per interval, zero selects every frame
+         */
+        PollEvent::Interface& event( std::chrono::nanoseconds interval );
+
+        /**
+         * Runs every group at its rate divided by 2^shift, as far as the slowest rate allows
+         */
+        void throttle( std::size_t shift ) { shift_ = shift; }
+
+        void tick( std::chrono::nanoseconds elapsed );
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        struct Group
+        {
+            std::size_t divisor;
+            std::size_t phase;
+            PollEvent event;
+            std::chrono::nanoseconds elapsed;
+            std::size_t ticks;
+            std::size_t dispatched;
+        };
+
+        std::size_t divisor( std::chrono::nanoseconds interval ) const;
+        std::size_t phase( std::size_t divisor ) const;
+        Group& group( std::size_t divisor, std::size_t phase );
+
+        std::chrono::nanoseconds interval_;
+        InlineFunction< void () > activation_;
+        std::vector< std::unique_ptr< Group > > groups_;
+        std::size_t shift_;
+        std::size_t frame_;
+        std::size_t frames_;
+        std::size_t dispatched_;
+        std::size_t peak_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_RATESCHEDULER_HPP
@@ -0,0 +1,281 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "core/commandline.hpp"
+#include "core/component.hpp"
+#include "core/logging.hpp"
+#include "core/properties.hpp"
+#include "core/realtime.hpp"
+
+#if SCHLAZICONTROL_REALTIME
+#   include <malloc.h>
+#   include <pthread.h>
+#   include <sched.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace sc {
+
+    static Logger logger( "realtime" );
+
+    static constexpr int defaultPriority = 50;
+    static constexpr size_t stackPrefault = 256 * 1024;
+
+#if SCHLAZICONTROL_REALTIME
+    static char const* policyName( int policy )
+    {
+        switch ( policy ) {
+            case SCHED_FIFO: return "fifo";
+            case SCHED_RR: return "rr";
+            default: return "other";
+        }
+    }
+
+    static string describeCpus( vector< int > const& cpus )
+    {
+        ostringstream os;
+        for ( auto it = cpus.begin() ; it != cpus.end() ; ) {
+            auto last = it;
+            while ( next( last ) != cpus.end() && *next( last ) == *last + 1 ) {
+                ++last;
+            }
+            os << ( it != cpus.begin() ? "," : "" ) << *it;
+            if ( last != it ) {
+                os << "-" << *last;
+            }
+            it = next( last );
+        }
+        return os.str();
+    }
+
+    static vector< int > currentCpus()
+    {
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        vector< int > result;
+        if ( ::sched_getaffinity( 0, sizeof( set ), &set ) == 0 ) {
+            for ( int cpu = 0 ; cpu < CPU_SETSIZE ; ++cpu ) {
+                if ( CPU_ISSET( cpu, &set ) ) {
+                    result.push_back( cpu );
+                }
+            }
+        }
+        return result;
+    }
+
+    static char const* privilegeHint( int error )
+    {
+        return error == EPERM ? " (missing CAP_SYS_NICE or RLIMIT_RTPRIO?)" : "";
+    }
+
+    // not inlined, so the array really occupies the stack below the caller
+    static void __attribute__(( noinline )) prefaultStack()
+    {
+        char stack[ stackPrefault ];
+        volatile char* pages = stack;
+        auto page = static_cast< size_t >( ::sysconf( _SC_PAGESIZE ) );
+        for ( size_t i = 0 ; i < stackPrefault ; i += page ) {
+            pages[ i ] = 0;
+        }
+    }
+
+    static void prefaultHeap( size_t size )
+    {
+#   if defined( __GLIBC__ )
+        // freed memory has to stay in the heap, or the prefaulted pages would be returned right away
+        ::mallopt( M_TRIM_THRESHOLD, -1 );
+        ::mallopt( M_MMAP_MAX, 0 );
+#   endif
+        auto heap = static_cast< volatile char* >( malloc( size ) );
+        if ( heap == nullptr ) {
+            return;
+        }
+        auto page = static_cast< size_t >( ::sysconf( _SC_PAGESIZE ) );
+        for ( size_t i = 0 ; i < size ; i += page ) {
+            heap[ i ] = 0;
+        }
+        free( const_cast< char* >( heap ) );
+    }
+#endif
+
+    /**
+     * class Realtime
+     */
+
+    static PropertyKey const schedulingProperty( "scheduling", "" );
+    static PropertyKey const cpuAffinityProperty( "cpuAffinity", "" );
+    static PropertyKey const processSchedulingProperty( "processScheduling", "" );
+    static PropertyKey const processCpuAffinityProperty( "processCpuAffinity", "" );
+    static PropertyKey const processesProperty( "processes", nlohmann::json::array() );
+    static PropertyKey const componentProperty( "component" );
+    static PropertyKey const lockMemoryProperty( "lockMemory", false );
+    static PropertyKey const prefaultMemoryProperty( "prefaultMemory", 8 * 1024 * 1024 );
+
+    // options on the command line take precedence over the configuration
+    static string setting( string const& commandLine, PropertyNode const& node )
+    {
+        return commandLine.empty() ? node.as< string >() : commandLine;
+    }
+
+    Realtime::Realtime( CommandLine const& commandLine, PropertyNode const& properties )
+            : mainLoop_( parse( setting( commandLine.scheduling(), properties[ schedulingProperty ] ),
+                                setting( commandLine.cpuAffinity(), properties[ cpuAffinityProperty ] ),
+                                properties.path() ) )
+            , process_( parse( setting( commandLine.processScheduling(), properties[ processSchedulingProperty ] ),
+                               setting( commandLine.processCpuAffinity(), properties[ processCpuAffinityProperty ] ),
+                               properties.path() ) )
+            , lockMemory_( commandLine.lockMemory() || properties[ lockMemoryProperty ].as< bool >() )
+            , prefault_( properties[ prefaultMemoryProperty ].as< size_t >() )
+#if SCHLAZICONTROL_REALTIME
+            , available_( currentCpus() )
+#endif
+    {
+        for ( auto processNode : properties[ processesProperty ] ) {
+            auto scheduling = processNode[ schedulingProperty ].as< string >();
+            auto cpuAffinity = processNode[ cpuAffinityProperty ].as< string >();
+            processes_.emplace(
+                    processNode[ componentProperty ].as< string >(),
+                    parse( scheduling.empty() ? process_.scheduling : scheduling,
+                           cpuAffinity.empty() ? process_.cpuAffinity : cpuAffinity, processNode.path() ) );
+        }
+    }
+
+    void Realtime::applyMainLoop() const
+    {
+        apply( "main loop", mainLoop_, false );
+        if ( lockMemory_ ) {
+            lockMemory( "main loop" );
+        }
+    }
+
+    void Realtime::applyProcess( Component const& component ) const
+    {
+        auto it = processes_.find( component.id() );
+        auto name = str( "process of ", component.id() );
+        apply( name, it != processes_.end() ? it->second : process_, true );
+        if ( lockMemory_ ) {
+            lockMemory( name );
+        }
+    }
+
+    Realtime::Settings Realtime::parse( string const& scheduling, string const& cpuAffinity, string const& path )
+    {
+        Settings result { scheduling, 0, 0, cpuAffinity, {} };
+#if SCHLAZICONTROL_REALTIME
+        result.policy = SCHED_OTHER;
+
+        auto separator = scheduling.find( ':' );
+        auto policy = scheduling.substr( 0, separator );
+        if ( policy == "fifo" || policy == "rr" ) {
+            result.policy = policy == "fifo" ? SCHED_FIFO : SCHED_RR;
+            result.priority = defaultPriority;
+            if ( separator != string::npos ) {
+                char* end;
+                result.priority = (int) strtol( scheduling.c_str() + separator + 1, &end, 10 );
+                if ( *end != '\0' || result.priority < ::sched_get_priority_min( result.policy )
+                     || result.priority > ::sched_get_priority_max( result.policy ) ) {
+                    throw runtime_error( str( "invalid priority in scheduling \"", scheduling, "\" in ", path ) );
+                }
+            }
+        }
+        else if ( !scheduling.empty() && ( policy != "other" || separator != string::npos ) ) {
+            throw runtime_error( str( "invalid scheduling \"", scheduling, "\" in ", path,
+                                      ", expected other, fifo[:priority] or rr[:priority]" ) );
+        }
+
+        // a list of cpus and ranges of cpus, like 0,2-3
+        istringstream is( cpuAffinity );
+        string item;
+        while ( getline( is, item, ',' ) ) {
+            char* end;
+            auto first = strtol( item.c_str(), &end, 10 );
+            auto last = *end == '-' ? strtol( end + 1, &end, 10 ) : first;
+            if ( item.empty() || *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE ) {
+                throw runtime_error( str( "invalid cpu affinity \"", cpuAffinity, "\" in ", path ) );
+            }
+            for ( auto cpu = first ; cpu <= last ; ++cpu ) {
+                result.cpus.push_back( (int) cpu );
+            }
+        }
+        sort( result.cpus.begin(), result.cpus.end() );
+        result.cpus.erase( unique( result.cpus.begin(), result.cpus.end() ), result.cpus.end() );
+#endif
+        return result;
+    }
+
+    void Realtime::apply( string const& name, Settings const& settings, bool reset ) const
+    {
+        auto configured = !settings.scheduling.empty() || !settings.cpuAffinity.empty();
+#if SCHLAZICONTROL_REALTIME
+        if ( !settings.scheduling.empty() || reset ) {
+            sched_param param {};
+            param.sched_priority = settings.priority;
+            auto error = ::pthread_setschedparam( ::pthread_self(), settings.policy, &param );
+            if ( error != 0 ) {
+                logger.warning( "couldn't set scheduling \"", settings.scheduling, "\" of ", name, ": ",
+                                strerror( error ), privilegeHint( error ), ", keeping the current scheduling" );
+            }
+        }
+
+        if ( !settings.cpus.empty() || reset ) {
+            auto const& cpus = settings.cpus.empty() ? available_ : settings.cpus;
+            cpu_set_t set;
+            CPU_ZERO( &set );
+            for ( auto cpu : cpus ) {
+                CPU_SET( cpu, &set );
+            }
+            auto error = ::pthread_setaffinity_np( ::pthread_self(), sizeof( set ), &set );
+            if ( error != 0 ) {
+                logger.warning( "couldn't set cpu affinity \"", describeCpus( cpus ), "\" of ", name, ": ",
+                                strerror( error ), ", keeping the current affinity" );
+            }
+        }
+
+        // reports what is actually in effect, whatever was refused
+        int policy;
+        sched_param param {};
+        ::pthread_getschedparam( ::pthread_self(), &policy, &param );
+        auto report = str( name, " runs with scheduling ", policyName( policy ), ":", param.sched_priority,
+                           " on cpus ", describeCpus( currentCpus() ) );
+        if ( configured ) {
+            logger.info( report );
+        }
+        else {
+            logger.debug( report );
+        }
+#else
+        if ( configured ) {
+            logger.warning( "scheduling and cpu affinity of ", name, " are not supported on this platform" );
+        }
+#endif
+    }
+
+    void Realtime::lockMemory( string const& name ) const
+    {
+#if SCHLAZICONTROL_REALTIME
+        if ( ::mlockall( MCL_CURRENT | MCL_FUTURE ) == -1 ) {
+            auto error = errno;
+            logger.warning( "couldn't lock the memory of ", name, ": ", strerror( error ),
+                            error == EPERM || error == ENOMEM ? " (missing CAP_IPC_LOCK or RLIMIT_MEMLOCK too low?)" : "",
+                            ", pages may still be swapped out" );
+            return;
+        }
+
+        // fault in the stack and heap the loop is going to use now, instead of while rendering a frame
+        prefaultStack();
+        prefaultHeap( prefault_ );
+        logger.info( "memory of ", name, " locked, ", prefault_, " bytes of heap and ", stackPrefault,
+                     " bytes of stack prefaulted" );
+#else
+        logger.warning( "locking the memory of ", name, " is not supported on this platform" );
+#endif
+    }
+
+} // namespace sc
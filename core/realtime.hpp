@@ -0,0 +1,69 @@
+#ifndef SCHLAZICONTROL_REALTIME_HPP
+#define SCHLAZICONTROL_REALTIME_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/config.hpp"
+
+namespace sc {
+
+    class CommandLine;
+    class Component;
+    class PropertyNode;
+
+    /**
+     * class Realtime
+     *
+     * Scheduling policy, CPU affinity and memory locking of the main loop and of the processes forked for
+     * components. Threads started by the main loop inherit its settings. Settings the system refuses, usually for
+     * lack of privileges, are reported and skipped, the controller then runs as it would without them.
+     *
+     * Forked processes that have no settings of their own run with the normal policy on all CPUs, even if they were
+     * restarted from an already tuned main loop.
+     */
+
+    class Realtime
+    {
+    public:
+        Realtime( CommandLine const& commandLine, PropertyNode const& properties );
+        Realtime( Realtime const& ) = delete;
+
+        /**
+         * Applies the settings of the main loop to the calling thread
+         */
+        void applyMainLoop() const;
+
+        /**
+         * Applies the settings of the process forked for the component, from within that process
+         */
+        void applyProcess( Component const& component ) const;
+
+    private:
+        struct Settings
+        {
+            std::string scheduling;
+            int policy;
+            int priority;
+            std::string cpuAffinity;
+            std::vector< int > cpus;
+        };
+
+        static Settings parse( std::string const& scheduling, std::string const& cpuAffinity, std::string const& path );
+
+        void apply( std::string const& name, Settings const& settings, bool reset ) const;
+        void lockMemory( std::string const& name ) const;
+
+        Settings mainLoop_;
+        Settings process_;
+        std::unordered_map< std::string, Settings > processes_;
+        bool lockMemory_;
+        std::size_t prefault_;
+        std::vector< int > available_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_REALTIME_HPP
@@ -0,0 +1,241 @@
+#include <exception>
+#include <future>
+#include <ostream>
+#include <utility>
+
+#include "core/logging.hpp"
+#include "core/renderthread.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static Logger logger( "renderthread" );
+
+    static thread_local bool rendering = false;
+
+    /**
+     * class FrameSlot
+     */
+
+    constexpr unsigned FrameSlot::fresh;
+
+    FrameSlot::FrameSlot( asio::io_context& service, Handler handler )
+            : service_( service )
+            , handler_( move( handler ) )
+            , middle_( 1 )
+            , posted_()
+            , back_( 0 )
+            , front_( 2 )
+            , published_()
+            , superseded_()
+    {
+    }
+
+    void FrameSlot::publish( ChannelBuffer const& values )
+    {
+        buffers_[ back_ ] = values;
+        auto previous = middle_.exchange( back_ | fresh, memory_order_acq_rel );
+        back_ = previous & ~fresh;
+
+        ++published_;
+        if ( ( previous & fresh ) != 0 ) {
+            ++superseded_;
+        }
+
+        if ( !posted_.exchange( true, memory_order_acq_rel ) ) {
+            service_.post( [this] { deliver(); } );
+        }
+    }
+
+    void FrameSlot::deliver()
+    {
+        // cleared before taking the frame, a frame published from here on posts another delivery
+        posted_.exchange( false, memory_order_acq_rel );
+        if ( ( middle_.load( memory_order_relaxed ) & fresh ) == 0 ) {
+            return;
+        }
+
+        front_ = middle_.exchange( front_, memory_order_acq_rel ) & ~fresh;
+        handler_( buffers_[ front_ ] );
+    }
+
+    /**
+     * class RenderThread
+     */
+
+    RenderThread::RenderThread( asio::io_context& service, bool enabled )
+            : service_( service )
+            , enabled_( enabled )
+            , work_( render_.get_executor() )
+            , running_()
+            , synchronizing_()
+            , head_( new Node { { nullptr }, nullptr } )
+            , tail_( head_.load() )
+            , scheduled_()
+            , posted_()
+            , handled_()
+            , drains_()
+    {
+    }
+
+    RenderThread::~RenderThread()
+    {
+        stop();
+
+        Handler handler;
+        while ( pop( handler ) ) {}
+        delete tail_;
+    }
+
+    bool RenderThread::current() const
+    {
+        return !enabled_ || rendering;
+    }
+
+    void RenderThread::start()
+    {
+        if ( !enabled_ || thread_.joinable() ) {
+            return;
+        }
+
+        logger.info( "starting render thread" );
+        running_ = true;
+        thread_ = thread( [this] { run(); } );
+    }
+
+    void RenderThread::stop()
+    {
+        if ( !thread_.joinable() ) {
+            return;
+        }
+
+        work_.reset();
+        render_.stop();
+        thread_.join();
+    }
+
+    void RenderThread::post( Handler handler )
+    {
+        push( new Node { { nullptr }, move( handler ) } );
+        ++posted_;
+
+        // one drain is enough for everything that is queued until it starts
+        if ( !scheduled_.exchange( true, memory_order_acq_rel ) ) {
+            render_.post( [this] { drain(); } );
+        }
+    }
+
+    void RenderThread::synchronize( Handler const& handler )
+    {
+        // the result tells whether the render thread ran the handler, it doesn't if it stops before getting to it
+        promise< bool > done;
+        auto result = done.get_future();
+        {
+            lock_guard< mutex > lock( mutex_ );
+            if ( running_ ) {
+                synchronizing_ = &done;
+                render_.post( [this, &handler] {
+                    exception_ptr error;
+                    try {
+                        handler();
+                    }
+                    catch ( ... ) {
+                        error = current_exception();
+                    }
+
+                    lock_guard< mutex > lock( mutex_ );
+                    if ( error ) {
+                        synchronizing_->set_exception( error );
+                    }
+                    else {
+                        synchronizing_->set_value( true );
+                    }
+                    synchronizing_ = nullptr;
+                } );
+            }
+            else {
+                done.set_value( false );
+            }
+        }
+
+        if ( !result.get() ) {
+            handler();
+        }
+    }
+
+    FrameSlot& RenderThread::slot( FrameSlot::Handler handler )
+    {
+        slots_.emplace_back( new FrameSlot( service_, move( handler ) ) );
+        return *slots_.back();
+    }
+
+    void RenderThread::statistics( ostream& os ) const
+    {
+        size_t published = 0;
+        size_t superseded = 0;
+        for ( auto const& slot : slots_ ) {
+            published += slot->published();
+            superseded += slot->superseded();
+        }
+
+        os << "\n\tRenderThread : enabled: " << enabled_ << ", queued: " << posted_ << ", handled: "
+           << handled_ << ", drains: " << drains_ << ", slots: " << slots_.size() << ", frames published: "
+           << published << ", superseded: " << superseded;
+    }
+
+    void RenderThread::push( Node* node )
+    {
+        auto previous = head_.exchange( node, memory_order_acq_rel );
+        previous->next.store( node, memory_order_release );
+    }
+
+    bool RenderThread::pop( Handler& handler )
+    {
+        // the tail is a consumed node, its successor holds the next handler and becomes the tail in turn
+        auto next = tail_->next.load( memory_order_acquire );
+        if ( next == nullptr ) {
+            return false;
+        }
+
+        handler = move( next->handler );
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
+
+    void RenderThread::drain()
+    {
+        ++drains_;
+
+        // cleared before draining, a handler pushed from here on schedules another drain
+        scheduled_.exchange( false, memory_order_acq_rel );
+
+        Handler handler;
+        while ( pop( handler ) ) {
+            ++handled_;
+            handler();
+        }
+    }
+
+    void RenderThread::run()
+    {
+        rendering = true;
+        try {
+            render_.run();
+        }
+        catch ( ... ) {
+            // rethrown by the IO thread, which fails just as if the error had happened there
+            service_.post( [error = current_exception()] { rethrow_exception( error ); } );
+        }
+
+        // a thread waiting in synchronize() runs its handler itself from now on
+        lock_guard< mutex > lock( mutex_ );
+        running_ = false;
+        if ( synchronizing_ != nullptr ) {
+            synchronizing_->set_value( false );
+            synchronizing_ = nullptr;
+        }
+    }
+
+} // namespace sc
@@ -0,0 +1,138 @@
+#ifndef SCHLAZICONTROL_RENDERTHREAD_HPP
+#define SCHLAZICONTROL_RENDERTHREAD_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <asio/executor_work_guard.hpp>
+#include <asio/io_context.hpp>
+
+#include "types.hpp"
+
+namespace sc {
+
+    /**
+     * class FrameSlot
+     *
+     * Hands the frames of a render-side input over to an output on the IO thread. Only the latest frame is kept: the
+     * render thread never waits for the IO thread, and a frame that the IO thread hasn't picked up when the next one
+     * is published is superseded. The three buffers rotate through atomic exchanges, so neither side takes a lock
+     * and at most one delivery is pending on the IO service at any time.
+     */
+
+    class FrameSlot
+    {
+    public:
+        using Handler = std::function< void ( ChannelBuffer const& values ) >;
+
+        FrameSlot( asio::io_context& service, Handler handler );
+        FrameSlot( FrameSlot const& ) = delete;
+
+        std::size_t published() const { return published_; }
+        std::size_t superseded() const { return superseded_; }
+
+        void publish( ChannelBuffer const& values );
+
+    private:
+        static constexpr unsigned fresh = 4;
+
+        void deliver();
+
+        asio::io_context& service_;
+        Handler handler_;
+        std::array< ChannelBuffer, 3 > buffers_;
+        std::atomic< unsigned > middle_;
+        std::atomic< bool > posted_;
+        unsigned back_;
+        unsigned front_;
+        std::size_t published_;
+        std::size_t superseded_;
+    };
+
+    /**
+     * class RenderThread
+     *
+     * Optionally runs the frame clock and everything it drives on a thread of its own, so frames don't wait for the
+     * network and file IO of the main loop. Input changes from other threads are handed over through a lock-free
+     * queue that is drained in a single pass on the render thread, however many changes arrived in between. Outputs
+     * on the IO thread receive their frames through frame slots.
+     *
+     * Without the thread the render service is the IO service, and nothing crosses a thread boundary.
+     */
+
+    class RenderThread
+    {
+    public:
+        using Handler = std::function< void () >;
+
+        RenderThread( asio::io_context& service, bool enabled );
+        RenderThread( RenderThread const& ) = delete;
+        ~RenderThread();
+
+        bool enabled() const { return enabled_; }
+
+        /**
+         * Returns whether the calling thread is the one that renders
+         */
+        bool current() const;
+
+        asio::io_context& service() { return enabled_ ? render_ : service_; }
+
+        void start();
+        void stop();
+
+        /**
+         * Queues a handler for the render thread, may be called from any thread
+         */
+        void post( Handler handler );
+
+        /**
+         * Runs the handler on the render thread while the calling thread waits for it, or on the calling thread if
+         * the render thread isn't running (anymore)
+         */
+        void synchronize( Handler const& handler );
+
+        FrameSlot& slot( FrameSlot::Handler handler );
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        struct Node
+        {
+            std::atomic< Node* > next;
+            Handler handler;
+        };
+
+        void push( Node* node );
+        bool pop( Handler& handler );
+        void drain();
+        void run();
+
+        asio::io_context& service_;
+        bool enabled_;
+        asio::io_context render_;
+        asio::executor_work_guard< asio::io_context::executor_type > work_;
+        std::thread thread_;
+        std::mutex mutex_;
+        bool running_;
+        std::promise< bool >* synchronizing_;
+        std::atomic< Node* > head_;
+        Node* tail_;
+        std::atomic< bool > scheduled_;
+        std::vector< std::unique_ptr< FrameSlot > > slots_;
+        std::atomic< std::size_t > posted_;
+        std::size_t handled_;
+        std::size_t drains_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_RENDERTHREAD_HPP
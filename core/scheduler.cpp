@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <iterator>
+#include <ostream>
+
+#include <asio.hpp>
+
+#include "core/scheduler.hpp"
+#include "core/workerpool.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * class Schedulable
+     */
+
+    Schedulable::Schedulable()
+            : scheduled_()
+            , deferred_()
+            , pass_()
+            , cost_()
+            , worstCost_()
+            , overruns_()
+    {
+    }
+
+    Schedulable::~Schedulable() = default;
+
+    /**
+     * class Scheduler
+     */
+
+    bool Scheduler::Entry::operator<( Entry const& other ) const
+    {
+        // std::push_heap builds a max heap, lowest rank first, first come first served within a rank
+        return rank != other.rank ? rank > other.rank : sequence > other.sequence;
+    }
+
+    Scheduler::Scheduler( asio::io_context& service, WorkerPool& workers )
+            : service_( service )
+            , workers_( workers )
+            , costliest_()
+            , dropRatio_( 1 )
+            , frames_()
+            , flushing_()
+            , posted_()
+            , sequence_()
+            , passes_()
+            , evaluations_()
+            , duplicates_()
+            , immediate_()
+            , rendered_()
+            , dropped_()
+            , lastPass_()
+            , maxPass_()
+    {
+    }
+
+    void Scheduler::schedule( Schedulable& node )
+    {
+        if ( node.scheduled_ ) {
+            return;
+        }
+
+        node.scheduled_ = true;
+        queue_.push_back( { node.rank(), sequence_++, &node } );
+        push_heap( queue_.begin(), queue_.end() );
+
+        if ( !flushing_ && !posted_ ) {
+            posted_ = true;
+            asio::post( service_, [this] { flush(); } );
+        }
+    }
+
+    void Scheduler::evaluate( Schedulable& node )
+    {
+        // the queue entry stays behind and is skipped when it comes up
+        node.scheduled_ = false;
+        ++immediate_;
+        node.evaluate();
+    }
+
+    void Scheduler::flush( bool frame )
+    {
+        posted_ = false;
+        if ( frame && !flushing_ ) {
+            ++frames_;
+            costliest_ = nullptr;
+
+            // nodes left over by the previous frame are still scheduled, only their entries need to be restored
+            for ( auto node : deferred_ ) {
+                node->deferred_ = false;
+                queue_.push_back( { node->rank(), sequence_++, node } );
+                push_heap( queue_.begin(), queue_.end() );
+            }
+            deferred_.clear();
+        }
+        if ( flushing_ || queue_.empty() ) {
+            return;
+        }
+
+        auto dropping = frame && dropRatio_ > 1 && frames_ % dropRatio_ != 0;
+
+        flushing_ = true;
+        ++passes_;
+        size_t evaluations = 0;
+        while ( !queue_.empty() ) {
+            // the nodes of the lowest rank don't depend on each other
+            auto rank = queue_.front().rank;
+            batch_.clear();
+            while ( !queue_.empty() && queue_.front().rank == rank ) {
+                pop_heap( queue_.begin(), queue_.end() );
+                auto node = queue_.back().node;
+                queue_.pop_back();
+                if ( !node->scheduled_ ) {
+                    continue;
+                }
+                if ( dropping && node->deferrable() ) {
+                    // a deferred node that was evaluated right away and scheduled itself again is deferred only once
+                    if ( !node->deferred_ ) {
+                        node->deferred_ = true;
+                        deferred_.push_back( node );
+                        ++dropped_;
+                    }
+                    continue;
+                }
+
+                node->scheduled_ = false;
+                if ( node->pass_ == passes_ ) {
+                    ++duplicates_;
+                }
+                node->pass_ = passes_;
+                node->cost_ = chrono::nanoseconds::zero();
+                batch_.push_back( node );
+            }
+
+            render();
+            for ( auto node : batch_ ) {
+                ++evaluations;
+                auto start = chrono::steady_clock::now();
+                node->evaluate();
+                node->cost_ += chrono::steady_clock::now() - start;
+                node->worstCost_ = max( node->worstCost_, node->cost_ );
+                if ( frame && ( costliest_ == nullptr || node->cost_ > costliest_->cost_ ) ) {
+                    costliest_ = node;
+                }
+            }
+        }
+        flushing_ = false;
+
+        evaluations_ += evaluations;
+        lastPass_ = evaluations;
+        maxPass_ = max( maxPass_, evaluations );
+    }
+
+    void Scheduler::render()
+    {
+        if ( workers_.threads() == 0 || batch_.size() < 2 ) {
+            return;
+        }
+
+        concurrent_.clear();
+        copy_if( batch_.begin(), batch_.end(), back_inserter( concurrent_ ),
+                 []( Schedulable* node ) { return node->concurrent(); } );
+        if ( concurrent_.size() < 2 ) {
+            return;
+        }
+
+        // one node per chunk, so that idle threads steal whole nodes from busy ones
+        workers_.parallelFor( concurrent_.size(), 1, [this]( size_t first, size_t last ) {
+            for ( auto i = first ; i < last ; ++i ) {
+                auto node = concurrent_[ i ];
+                auto start = chrono::steady_clock::now();
+                node->render();
+                node->cost_ += chrono::steady_clock::now() - start;
+            }
+        } );
+        rendered_ += concurrent_.size();
+    }
+
+    void Scheduler::statistics( ostream& os ) const
+    {
+        os << "\n\tScheduler : passes: " << passes_ << ", evaluations: " << evaluations_
+           << ", last pass: " << lastPass_ << ", max pass: " << maxPass_ << ", duplicates: " << duplicates_
+           << ", immediate: " << immediate_ << ", rendered concurrently: " << rendered_ << ", dropped: " << dropped_;
+    }
+
+} // namespace sc
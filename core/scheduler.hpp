@@ -0,0 +1,160 @@
+#ifndef SCHLAZICONTROL_SCHEDULER_HPP
+#define SCHLAZICONTROL_SCHEDULER_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+
+#include <asio/io_context.hpp>
+
+namespace sc {
+
+    class Scheduler;
+    class WorkerPool;
+
+    /**
+     * class Schedulable
+     *
+     * A node of the component graph that is evaluated by the scheduler instead of directly when its inputs change.
+     * The rank orders the nodes topologically: a node's rank must be greater than the rank of every node it depends
+     * on.
+     */
+
+    class Schedulable
+    {
+        friend class Scheduler;
+
+    public:
+        Schedulable();
+        Schedulable( Schedulable const& ) = delete;
+        virtual ~Schedulable();
+
+        virtual std::size_t rank() const = 0;
+
+        /**
+         * Returns the time the node took when it was last evaluated, and the longest time it ever took
+         */
+        std::chrono::nanoseconds cost() const { return cost_; }
+        std::chrono::nanoseconds worstCost() const { return worstCost_; }
+
+        /**
+         * Counts the frames over budget in which the node took longest
+         */
+        std::size_t overruns() const { return overruns_; }
+
+    protected:
+        /**
+         * Returns whether the evaluation may be left to a later frame while frames are dropped for such nodes
+         */
+        virtual bool deferrable() const { return false; }
+
+        /**
+         * Returns whether the node can be rendered on a worker thread in the current pass
+         */
+        virtual bool concurrent() const { return false; }
+
+        /**
+         * Does the part of the evaluation that only touches the node itself. It runs concurrently with the other
+         * nodes of the same rank, the evaluation on the IO thread that follows it commits the result.
+         */
+        virtual void render() {}
+
+        virtual void evaluate() = 0;
+
+    private:
+        bool scheduled_;
+        bool deferred_;
+        std::size_t pass_;
+        std::chrono::nanoseconds cost_;
+        std::chrono::nanoseconds worstCost_;
+        std::size_t overruns_;
+    };
+
+    /**
+     * class Scheduler
+     *
+     * Collects dirty nodes and evaluates each of them once per pass in topological order, so that a node depending
+     * on several changed nodes or polled by several stages is still evaluated only once. A pass runs after every
+     * frame and, for changes coming from outside the frame, as soon as the event loop gets to it.
+     *
+     * Nodes of the same rank don't depend on each other. If there are worker threads, the nodes of a rank that can
+     * be rendered concurrently are rendered in parallel before the nodes are evaluated one after the other.
+     *
+     * Every evaluation is timed, so the node that took longest in a frame can be named. While frames are dropped,
+     * deferrable nodes that come up on a dropped frame stay scheduled until the next frame.
+     */
+
+    class Scheduler
+    {
+    public:
+        Scheduler( asio::io_context& service, WorkerPool& workers );
+
+        bool empty() const { return queue_.empty() && deferred_.empty(); }
+        bool flushing() const { return flushing_; }
+        bool scheduled( Schedulable const& node ) const { return node.scheduled_; }
+
+        void schedule( Schedulable& node );
+
+        /**
+         * Evaluates a scheduled node right away, used to not lose changes that arrive while the node is still
+         * pending from an earlier event
+         */
+        void evaluate( Schedulable& node );
+
+        /**
+         * Evaluates all scheduled nodes, frame is set for the pass that follows each frame
+         */
+        void flush( bool frame = false );
+
+        /**
+         * Evaluates deferrable nodes only on every ratio-th frame
+         */
+        void dropping( std::size_t ratio ) { dropRatio_ = ratio; }
+
+        /**
+         * Returns the node that took longest in the last frame, if any node was evaluated
+         */
+        Schedulable* costliest() const { return costliest_; }
+
+        void blame( Schedulable& node ) { ++node.overruns_; }
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        struct Entry
+        {
+            std::size_t rank;
+            std::size_t sequence;
+            Schedulable* node;
+
+            bool operator<( Entry const& other ) const;
+        };
+
+        void render();
+
+        asio::io_context& service_;
+        WorkerPool& workers_;
+        std::vector< Entry > queue_;
+        std::vector< Schedulable* > batch_;
+        std::vector< Schedulable* > concurrent_;
+        std::vector< Schedulable* > deferred_;
+        Schedulable* costliest_;
+        std::size_t dropRatio_;
+        std::size_t frames_;
+        bool flushing_;
+        bool posted_;
+        std::size_t sequence_;
+        std::size_t passes_;
+        std::size_t evaluations_;
+        std::size_t duplicates_;
+        std::size_t immediate_;
+        std::size_t rendered_;
+        std::size_t dropped_;
+        std::size_t lastPass_;
+        std::size_t maxPass_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_SCHEDULER_HPP
@@ -0,0 +1,489 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <asio.hpp>
+
+#include "core/component.hpp"
+#include "core/logging.hpp"
+#include "core/properties.hpp"
+#include "core/realtime.hpp"
+#include "core/supervisor.hpp"
+
+#if SCHLAZICONTROL_FORK
+#   include <fcntl.h>
+#   include <poll.h>
+#   include <sys/socket.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace sc {
+
+    static Logger logger( "supervisor" );
+
+#if SCHLAZICONTROL_FORK
+    static bool processExited( pid_t pid )
+    {
+        int status;
+        auto result = ::waitpid( pid, &status, WNOHANG );
+        return result == pid || ( result == -1 && errno == ECHILD );
+    }
+
+    static void killGracefully( pid_t pid, size_t timeoutMs = 1000 )
+    {
+        if ( processExited( pid ) ) {
+            return;
+        }
+
+        logger.debug( "terminating process ", pid );
+
+        ::kill( pid, SIGTERM );
+        while ( timeoutMs > 0 ) {
+            int status;
+            if ( ::waitpid( pid, &status, WNOHANG ) == pid ) {
+                return;
+            }
+            this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+            timeoutMs = timeoutMs > 100 ? timeoutMs - 100 : 0;
+        }
+
+        logger.debug( "termination failed, killing process ", pid );
+
+        ::kill( pid, SIGKILL );
+    }
+
+    static string describeStatus( int status )
+    {
+        if ( WIFSIGNALED( status ) ) {
+            return str( "was killed by signal ", WTERMSIG( status ) );
+        }
+        return str( "exited with status ", WEXITSTATUS( status ) );
+    }
+
+    // the launcher learns about signals through a pipe, which it polls along with its socket. The pipe doesn't block,
+    // so the signal handler can't get stuck writing to it
+    static int launcherSignals[ 2 ];
+
+    static void notifyLauncher( int signal )
+    {
+        auto error = errno;
+        auto value = (unsigned char) signal;
+        if ( ::write( launcherSignals[ 1 ], &value, 1 ) != 1 ) {
+            // the pipe is full, the signals already waiting in it have the launcher look anyway
+        }
+        errno = error;
+    }
+
+    static void handleSignals( void ( *handler )( int ) )
+    {
+        struct sigaction action {};
+        action.sa_handler = handler;
+        sigemptyset( &action.sa_mask );
+        action.sa_flags = SA_RESTART;
+        for ( auto signal : { SIGCHLD, SIGINT, SIGTERM } ) {
+            ::sigaction( signal, &action, nullptr );
+        }
+    }
+#endif
+
+    static Supervisor::Policy parsePolicy( string const& policy )
+    {
+        if ( policy == "restart" ) {
+            return Supervisor::Policy::restart;
+        }
+        if ( policy == "shutdown" ) {
+            return Supervisor::Policy::shutdown;
+        }
+        throw runtime_error( str( "unknown restart policy \"", policy, "\"" ) );
+    }
+
+    /**
+     * struct Supervisor::Child
+     */
+
+    struct Supervisor::Child
+    {
+        Child( asio::io_context& service, size_t index, Component const& component, Handler&& handler )
+                : index( index )
+                , component( component )
+                , handler( move( handler ) )
+                , timer( service )
+        {
+        }
+
+        size_t index;
+        Component const& component;
+        Handler handler;
+        asio::steady_timer timer;
+        int pid {};
+        chrono::steady_clock::time_point started;
+        chrono::nanoseconds delay {};
+        size_t restarts {};
+        size_t consecutive {};
+    };
+
+    /**
+     * class Supervisor
+     */
+
+    static PropertyKey const restartPolicyProperty( "restartPolicy", "restart" );
+    static PropertyKey const restartDelayProperty( "restartDelay", "1s" );
+    static PropertyKey const restartDelayMaxProperty( "restartDelayMax", "1min" );
+    static PropertyKey const restartLimitProperty( "restartLimit", 0 );
+
+    Supervisor::Supervisor( asio::io_context& service, Realtime const& realtime, PropertyNode const& properties,
+                            function< void () > shutdown )
+            : service_( service )
+            , realtime_( realtime )
+            , policy_( parsePolicy( properties[ restartPolicyProperty ].as< string >() ) )
+            , restartDelay_( properties[ restartDelayProperty ].as< chrono::nanoseconds >() )
+            , restartDelayMax_( properties[ restartDelayMaxProperty ].as< chrono::nanoseconds >() )
+            , restartLimit_( properties[ restartLimitProperty ].as< size_t >() )
+            , shutdown_( move( shutdown ) )
+#if SCHLAZICONTROL_FORK
+            , signals_( service, SIGCHLD )
+            , launcher_( service )
+            , launcherPid_()
+            , report_()
+#endif
+            , terminating_()
+    {
+    }
+
+    Supervisor::~Supervisor() = default;
+
+    bool Supervisor::spawn( Component const& component, Handler handler )
+    {
+        if ( children_.empty() ) {
+            wait();
+        }
+
+        children_.emplace_back( new Child( service_, children_.size(), component, move( handler ) ) );
+        return fork( *children_.back() );
+    }
+
+    void Supervisor::startLauncher()
+    {
+#if SCHLAZICONTROL_FORK
+        if ( children_.empty() || policy_ != Policy::restart ) {
+            return;
+        }
+
+        int sockets[ 2 ];
+        if ( ::socketpair( AF_UNIX, SOCK_STREAM, 0, sockets ) == -1 ) {
+            throw system_error( errno, std::system_category(), "couldn't create the socket of the launcher" );
+        }
+
+        service_.notify_fork( asio::io_context::fork_prepare );
+        auto pid = ::fork();
+        if ( pid == -1 ) {
+            throw system_error( errno, std::system_category(), "couldn't start the launcher process" );
+        }
+        if ( pid == 0 ) {
+            ::close( sockets[ 0 ] );
+            launch( sockets[ 1 ] );
+        }
+        service_.notify_fork( asio::io_context::fork_parent );
+
+        ::close( sockets[ 1 ] );
+        launcher_.assign( asio::local::stream_protocol(), sockets[ 0 ] );
+        launcherPid_ = pid;
+        logger.debug( "started launcher process ", pid );
+        receive();
+#endif
+    }
+
+    void Supervisor::terminate()
+    {
+        terminating_ = true;
+#if SCHLAZICONTROL_FORK
+        signals_.cancel();
+        for ( auto const& child : children_ ) {
+            child->timer.cancel();
+            if ( child->pid != 0 ) {
+                killGracefully( child->pid );
+            }
+        }
+
+        // the launcher terminates the processes it restarted before it exits
+        if ( launcherPid_ != 0 ) {
+            launcher_.close();
+            killGracefully( launcherPid_, 1000 * ( children_.size() + 1 ) );
+            launcherPid_ = 0;
+        }
+#endif
+    }
+
+    void Supervisor::statistics( ostream& os ) const
+    {
+        if ( children_.empty() ) {
+            return;
+        }
+
+        os << "\n\tSupervisor : policy: " << ( policy_ == Policy::restart ? "restart" : "shutdown" );
+#if SCHLAZICONTROL_FORK
+        os << ", launcher: " << launcherPid_;
+#endif
+        for ( auto const& child : children_ ) {
+            os << "\n\t\t" << child->component.describe() << ": pid: " << child->pid
+               << ", restarts: " << child->restarts;
+        }
+    }
+
+    void Supervisor::wait()
+    {
+#if SCHLAZICONTROL_FORK
+        signals_.async_wait( [this]( asio::error_code ec, int ) {
+            if ( ec == make_error_code( asio::error::operation_aborted ) || terminating_ ) {
+                return;
+            }
+            reap();
+            wait();
+        } );
+#endif
+    }
+
+    void Supervisor::reap()
+    {
+#if SCHLAZICONTROL_FORK
+        // signals coalesce, so every child has to be checked
+        int status;
+        for ( auto const& child : children_ ) {
+            if ( child->pid != 0 && ::waitpid( child->pid, &status, WNOHANG ) == child->pid ) {
+                exited( *child, status );
+            }
+        }
+
+        // the launcher only exits unexpectedly, which the closed socket reports
+        if ( launcherPid_ != 0 && ::waitpid( launcherPid_, &status, WNOHANG ) == launcherPid_ ) {
+            launcherPid_ = 0;
+        }
+#endif
+    }
+
+    void Supervisor::exited( Child& child, int status )
+    {
+#if SCHLAZICONTROL_FORK
+        auto pid = child.pid;
+        child.pid = 0;
+
+        if ( policy_ == Policy::shutdown ) {
+            logger.error( "process ", pid, " of component ", child.component.describe(), " ", describeStatus( status ),
+                          ", shutting down" );
+            shutdown_();
+            return;
+        }
+
+        // a process that ran stable for a while starts over with the initial delay
+        auto uptime = chrono::steady_clock::now() - child.started;
+        if ( uptime >= restartDelayMax_ ) {
+            child.delay = restartDelay_;
+            child.consecutive = 0;
+        }
+        else {
+            child.delay = child.consecutive == 0 ? restartDelay_ : min( child.delay * 2, restartDelayMax_ );
+        }
+
+        if ( restartLimit_ != 0 && child.consecutive >= restartLimit_ ) {
+            logger.error( "process ", pid, " of component ", child.component.describe(), " ", describeStatus( status ),
+                          " after ", child.consecutive, " restarts, shutting down" );
+            shutdown_();
+            return;
+        }
+
+        logger.error( "process ", pid, " of component ", child.component.describe(), " ", describeStatus( status ),
+                      ", restarting in ", chrono::duration_cast< chrono::milliseconds >( child.delay ).count(), "ms" );
+
+        child.timer.expires_from_now( child.delay );
+        child.timer.async_wait( [this, &child]( asio::error_code ec ) {
+            if ( ec == make_error_code( asio::error::operation_aborted ) || terminating_ ) {
+                return;
+            }
+            restart( child );
+        } );
+#endif
+    }
+
+    bool Supervisor::fork( Child& child )
+    {
+#if SCHLAZICONTROL_FORK
+        service_.notify_fork( asio::io_context::fork_prepare );
+        auto pid = ::fork();
+        if ( pid == -1 ) {
+            throw system_error(
+                    errno, std::system_category(), str( "couldn't start process for component ", child.component.id() ) );
+        }
+        if ( pid == 0 ) {
+            service_.notify_fork( asio::io_context::fork_child );
+            realtime_.applyProcess( child.component );
+            return true;
+        }
+        service_.notify_fork( asio::io_context::fork_parent );
+
+        child.pid = pid;
+        child.started = chrono::steady_clock::now();
+        logger.debug( "started process ", pid, " for component ", child.component.describe() );
+#endif
+        return false;
+    }
+
+    void Supervisor::restart( Child& child )
+    {
+#if SCHLAZICONTROL_FORK
+        ++child.restarts;
+        ++child.consecutive;
+
+        // the controller runs threads by now, so the launcher forks on its behalf
+        auto index = (uint32_t) child.index;
+        if ( ::write( launcher_.native_handle(), &index, sizeof( index ) ) != sizeof( index ) ) {
+            logger.error( "couldn't have the launcher restart the process of component ", child.component.describe(),
+                          ": ", strerror( errno ), ", shutting down" );
+            shutdown_();
+        }
+#endif
+    }
+
+    void Supervisor::receive()
+    {
+#if SCHLAZICONTROL_FORK
+        asio::async_read( launcher_, asio::buffer( &report_, sizeof( report_ ) ), [this]( asio::error_code ec, size_t ) {
+            if ( ec == make_error_code( asio::error::operation_aborted ) || terminating_ ) {
+                return;
+            }
+            if ( ec ) {
+                logger.error( "lost the launcher process: ", ec.message(), ", shutting down" );
+                shutdown_();
+                return;
+            }
+            received( report_ );
+            receive();
+        } );
+#endif
+    }
+
+    void Supervisor::received( Report const& report )
+    {
+#if SCHLAZICONTROL_FORK
+        auto& child = *children_[ report.child ];
+        switch ( report.kind ) {
+            case Report::started:
+                child.pid = report.pid;
+                child.started = chrono::steady_clock::now();
+                logger.debug( "launcher started process ", child.pid, " for component ", child.component.describe() );
+                break;
+            case Report::exited:
+                exited( child, report.status );
+                break;
+            case Report::failed:
+                logger.error( "couldn't restart the process of component ", child.component.describe(), ": ",
+                              strerror( report.status ), ", shutting down" );
+                shutdown_();
+                break;
+        }
+#endif
+    }
+
+#if SCHLAZICONTROL_FORK
+    void Supervisor::launch( int socket )
+    {
+        if ( ::pipe2( launcherSignals, O_NONBLOCK | O_CLOEXEC ) == -1 ) {
+            ::_exit( EXIT_FAILURE );
+        }
+        handleSignals( &notifyLauncher );
+
+        auto send = [socket]( Report const& report ) {
+            if ( ::write( socket, &report, sizeof( report ) ) != sizeof( report ) ) {
+                // the controller is gone, the launcher notices when it reads next
+            }
+        };
+
+        vector< pid_t > pids( children_.size() );
+        pollfd fds[] = { { socket, POLLIN, 0 }, { launcherSignals[ 0 ], POLLIN, 0 } };
+        for ( auto running = true ; running ; ) {
+            if ( ::poll( fds, 2, -1 ) == -1 ) {
+                if ( errno == EINTR ) {
+                    continue;
+                }
+                break;
+            }
+
+            if ( ( fds[ 1 ].revents & POLLIN ) != 0 ) {
+                unsigned char signal;
+                if ( ::read( launcherSignals[ 0 ], &signal, 1 ) == 1 && signal != SIGCHLD ) {
+                    running = false;
+                }
+
+                int status;
+                pid_t pid;
+                while ( ( pid = ::waitpid( -1, &status, WNOHANG ) ) > 0 ) {
+                    auto it = find( pids.begin(), pids.end(), pid );
+                    if ( it != pids.end() ) {
+                        *it = 0;
+                        send( { (uint32_t) ( it - pids.begin() ), Report::exited, pid, status } );
+                    }
+                }
+            }
+
+            if ( running && fds[ 0 ].revents != 0 ) {
+                uint32_t index;
+                if ( ::read( socket, &index, sizeof( index ) ) != sizeof( index ) || index >= pids.size() ) {
+                    break;
+                }
+
+                auto pid = ::fork();
+                if ( pid == 0 ) {
+                    ::close( socket );
+                    ::close( launcherSignals[ 0 ] );
+                    ::close( launcherSignals[ 1 ] );
+                    handleSignals( SIG_DFL );
+                    run( *children_[ index ] );
+                }
+                if ( pid == -1 ) {
+                    send( { index, Report::failed, 0, errno } );
+                }
+                else {
+                    pids[ index ] = pid;
+                    send( { index, Report::started, pid, 0 } );
+                }
+            }
+        }
+
+        // the controller is shutting down or gone, the processes go along with it
+        for ( auto pid : pids ) {
+            if ( pid != 0 ) {
+                killGracefully( pid );
+            }
+        }
+        ::_exit( EXIT_SUCCESS );
+    }
+
+    void Supervisor::run( Child& child )
+    {
+        realtime_.applyProcess( child.component );
+
+        // the process is a copy of the launcher, it must never return into its loop
+        Logger processLogger( string( child.component.name() ) );
+        auto result = false;
+        try {
+            processLogger.info( child.component.name(), " restarting" );
+            result = child.handler();
+            processLogger.info( child.component.name(), " exiting" );
+        }
+        catch ( exception const& e ) {
+            processLogger.error( e.what() );
+        }
+        ::_exit( result ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+#endif
+
+} // namespace sc
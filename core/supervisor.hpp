@@ -0,0 +1,122 @@
+#ifndef SCHLAZICONTROL_SUPERVISOR_HPP
+#define SCHLAZICONTROL_SUPERVISOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio/io_context.hpp>
+#include <asio/local/stream_protocol.hpp>
+#include <asio/signal_set.hpp>
+#include <asio/steady_timer.hpp>
+
+#include "core/config.hpp"
+
+namespace sc {
+
+    class Component;
+    class PropertyNode;
+    class Realtime;
+
+    /**
+     * class Supervisor
+     *
+     * Watches the processes forked for components. Their exits are noticed through SIGCHLD in the event loop
+     * instead of by polling. Depending on the restart policy, a process that exits is either started again after an
+     * exponentially growing delay or shuts the controller down. Each forked process applies its own scheduling
+     * settings, see Realtime.
+     *
+     * Once the controller starts threads, forking it is no longer safe, as the child may find locks held by threads
+     * it doesn't have. Restarts are therefore forked by a launcher process, which is forked itself while the
+     * controller is still single threaded. The launcher reports the processes it starts and their exits back
+     * through a socket.
+     */
+
+    class Supervisor
+    {
+    public:
+        using Handler = std::function< bool () >;
+
+        enum class Policy
+        {
+            restart,
+            shutdown
+        };
+
+        Supervisor( asio::io_context& service, Realtime const& realtime, PropertyNode const& properties,
+                    std::function< void () > shutdown );
+        Supervisor( Supervisor const& ) = delete;
+        ~Supervisor();
+
+        /**
+         * Forks the process of the component, returns true in the forked process
+         */
+        bool spawn( Component const& component, Handler handler );
+
+        /**
+         * Forks the launcher for restarts, after all processes have been spawned and before any thread is started
+         */
+        void startLauncher();
+
+        /**
+         * Stops supervising and terminates all processes
+         */
+        void terminate();
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        struct Child;
+
+        struct Report
+        {
+            enum Kind : std::uint32_t
+            {
+                started,
+                exited,
+                failed
+            };
+
+            std::uint32_t child;
+            Kind kind;
+            std::int32_t pid;
+            std::int32_t status;
+        };
+
+        void wait();
+        void reap();
+        void exited( Child& child, int status );
+        bool fork( Child& child );
+        void restart( Child& child );
+        void receive();
+        void received( Report const& report );
+#if SCHLAZICONTROL_FORK
+        [[noreturn]] void launch( int socket );
+        [[noreturn]] void run( Child& child );
+#endif
+
+        asio::io_context& service_;
+        Realtime const& realtime_;
+        Policy policy_;
+        std::chrono::nanoseconds restartDelay_;
+        std::chrono::nanoseconds restartDelayMax_;
+        std::size_t restartLimit_;
+        std::function< void () > shutdown_;
+#if SCHLAZICONTROL_FORK
+        asio::signal_set signals_;
+        asio::local::stream_protocol::socket launcher_;
+        int launcherPid_;
+        Report report_;
+#endif
+        std::vector< std::unique_ptr< Child > > children_;
+        bool terminating_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_SUPERVISOR_HPP
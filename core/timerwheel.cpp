@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <ostream>
+
+#include <asio.hpp>
+
+#include "core/timerwheel.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static uint64_t rotateRight( uint64_t value, size_t count )
+    {
+        count &= 63;
+        return count == 0 ? value : ( value >> count ) | ( value << ( 64 - count ) );
+    }
+
+    /**
+     * class Expirable
+     */
+
+    Expirable::Expirable()
+            : previous_()
+            , next_()
+            , deadline_()
+            , level_()
+            , index_()
+            , running_()
+    {
+    }
+
+    Expirable::~Expirable() = default;
+
+    /**
+     * class TimerWheel
+     */
+
+    constexpr chrono::milliseconds TimerWheel::resolution;
+    constexpr size_t TimerWheel::levelBits;
+    constexpr size_t TimerWheel::slotCount;
+    constexpr size_t TimerWheel::levelCount;
+
+    TimerWheel::TimerWheel( asio::io_context& service )
+            : timer_( service )
+            , origin_( Clock::now() )
+            , now_()
+            , levels_()
+            , advancing_()
+            , armed_()
+            , armedTick_()
+            , active_()
+            , started_()
+            , expired_()
+            , cascaded_()
+            , wakeups_()
+    {
+    }
+
+    TimerWheel::~TimerWheel()
+    {
+        for ( auto& level : levels_ ) {
+            for ( auto timer : level.slots ) {
+                for ( ; timer != nullptr ; timer = timer->next_ ) {
+                    timer->running_ = false;
+                }
+            }
+        }
+    }
+
+    void TimerWheel::start( Expirable& timer, chrono::nanoseconds timeout )
+    {
+        if ( timer.running_ ) {
+            unlink( timer );
+        }
+        else {
+            ++active_;
+        }
+
+        // an idle wheel catches up with the clock right away, otherwise it does on the next wakeup. A timer started
+        // while the wheel expires others is inserted relative to the tick being processed, catching up there would
+        // move past the slot that is still being emptied and the timer could land in it
+        if ( active_ == 1 && !advancing_ ) {
+            now_ = max( now_, currentTick() );
+        }
+
+        // round up, a timer never expires early
+        auto deadline = chrono::duration_cast< chrono::nanoseconds >( Clock::now() - origin_ ) + timeout;
+        timer.deadline_ = (uint64_t) ( ( deadline + resolution - chrono::nanoseconds( 1 ) ) / resolution );
+        insert( timer, now_ + 1 );
+        ++started_;
+        schedule();
+    }
+
+    void TimerWheel::stop( Expirable& timer )
+    {
+        if ( !timer.running_ ) {
+            return;
+        }
+
+        unlink( timer );
+        if ( --active_ == 0 ) {
+            armed_ = false;
+            timer_.cancel();
+        }
+    }
+
+    void TimerWheel::statistics( ostream& os ) const
+    {
+        os << "\n\tTimerWheel : active: " << active_ << ", started: " << started_ << ", expired: " << expired_
+           << ", cascaded: " << cascaded_ << ", wakeups: " << wakeups_;
+    }
+
+    uint64_t TimerWheel::currentTick() const
+    {
+        return (uint64_t) ( ( Clock::now() - origin_ ) / resolution );
+    }
+
+    void TimerWheel::insert( Expirable& timer, uint64_t earliest )
+    {
+        // the lowest level whose revolution reaches the deadline, timeouts beyond the top level wait in its last slot
+        auto deadline = max( timer.deadline_, earliest );
+        size_t level = 0;
+        while ( level < levelCount - 1
+                && ( deadline >> ( level * levelBits ) ) - ( now_ >> ( level * levelBits ) ) >= slotCount ) {
+            ++level;
+        }
+        auto shift = level * levelBits;
+        auto position = min( deadline >> shift, ( now_ >> shift ) + slotCount - 1 );
+        auto index = (size_t) ( position & ( slotCount - 1 ) );
+
+        auto& head = levels_[ level ].slots[ index ];
+        timer.previous_ = nullptr;
+        timer.next_ = head;
+        if ( head != nullptr ) {
+            head->previous_ = &timer;
+        }
+        head = &timer;
+        levels_[ level ].occupied |= uint64_t( 1 ) << index;
+
+        timer.level_ = (uint8_t) level;
+        timer.index_ = (uint8_t) index;
+        timer.running_ = true;
+    }
+
+    void TimerWheel::unlink( Expirable& timer )
+    {
+        auto& level = levels_[ timer.level_ ];
+        if ( timer.previous_ != nullptr ) {
+            timer.previous_->next_ = timer.next_;
+        }
+        else {
+            level.slots[ timer.index_ ] = timer.next_;
+        }
+        if ( timer.next_ != nullptr ) {
+            timer.next_->previous_ = timer.previous_;
+        }
+        if ( level.slots[ timer.index_ ] == nullptr ) {
+            level.occupied &= ~( uint64_t( 1 ) << timer.index_ );
+        }
+        timer.running_ = false;
+    }
+
+    bool TimerWheel::nextTick( uint64_t& tick ) const
+    {
+        // the next occupied slot of every level follows from its occupancy mask, rotated to start behind the
+        // current slot
+        auto found = false;
+        for ( size_t level = 0 ; level < levelCount ; ++level ) {
+            auto occupied = levels_[ level ].occupied;
+            if ( occupied == 0 ) {
+                continue;
+            }
+
+            auto shift = level * levelBits;
+            auto current = now_ >> shift;
+            auto rotated = rotateRight( occupied, (size_t) ( current & ( slotCount - 1 ) ) + 1 );
+            auto candidate = ( current + (uint64_t) __builtin_ctzll( rotated ) + 1 ) << shift;
+            if ( !found || candidate < tick ) {
+                tick = candidate;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    void TimerWheel::advance( uint64_t target )
+    {
+        advancing_ = true;
+        uint64_t tick;
+        while ( nextTick( tick ) && tick <= target ) {
+            now_ = tick;
+            process( tick );
+        }
+        now_ = max( now_, target );
+        advancing_ = false;
+    }
+
+    void TimerWheel::process( uint64_t tick )
+    {
+        // higher levels first, their timeouts may move down into the slot of the level below that is due as well
+        for ( auto level = levelCount - 1 ; level > 0 ; --level ) {
+            auto shift = level * levelBits;
+            if ( ( tick & ( ( uint64_t( 1 ) << shift ) - 1 ) ) != 0 ) {
+                continue;
+            }
+
+            auto& head = levels_[ level ].slots[ ( tick >> shift ) & ( slotCount - 1 ) ];
+            while ( auto timer = head ) {
+                unlink( *timer );
+                insert( *timer, now_ );
+                ++cascaded_;
+            }
+        }
+
+        auto& head = levels_[ 0 ].slots[ tick & ( slotCount - 1 ) ];
+        while ( auto timer = head ) {
+            unlink( *timer );
+            --active_;
+            ++expired_;
+            timer->expire();
+        }
+    }
+
+    void TimerWheel::schedule()
+    {
+        uint64_t tick;
+        if ( !nextTick( tick ) || ( armed_ && armedTick_ <= tick ) ) {
+            return;
+        }
+
+        armed_ = true;
+        armedTick_ = tick;
+        timer_.expires_at( origin_ + tick * resolution );
+        timer_.async_wait( [this]( asio::error_code ec ) {
+            if ( ec == make_error_code( asio::error::operation_aborted ) ) {
+                return;
+            }
+
+            armed_ = false;
+            ++wakeups_;
+            advance( currentTick() );
+            schedule();
+        } );
+    }
+
+} // namespace sc
@@ -0,0 +1,109 @@
+#ifndef SCHLAZICONTROL_TIMERWHEEL_HPP
+#define SCHLAZICONTROL_TIMERWHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <iosfwd>
+
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+
+namespace sc {
+
+    class TimerWheel;
+
+    /**
+     * class Expirable
+     *
+     * A timeout managed by the timer wheel. It is linked into the slot of its deadline directly, so starting and
+     * stopping it neither searches nor allocates.
+     */
+
+    class Expirable
+    {
+        friend class TimerWheel;
+
+    public:
+        Expirable();
+        Expirable( Expirable const& ) = delete;
+        virtual ~Expirable();
+
+        bool running() const { return running_; }
+
+    protected:
+        virtual void expire() = 0;
+
+    private:
+        Expirable* previous_;
+        Expirable* next_;
+        std::uint64_t deadline_;
+        std::uint8_t level_;
+        std::uint8_t index_;
+        bool running_;
+    };
+
+    /**
+     * class TimerWheel
+     *
+     * Hierarchical timing wheel of millisecond ticks shared by all timers. Each level has 64 slots, each slot of a
+     * level spans a full revolution of the level below, and timeouts move down a level whenever the wheel reaches
+     * their slot. The wheel wakes up only when a slot that holds timeouts is due, independently of the frame clock.
+     */
+
+    class TimerWheel
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::chrono::milliseconds resolution { 1 };
+
+        explicit TimerWheel( asio::io_context& service );
+        TimerWheel( TimerWheel const& ) = delete;
+        ~TimerWheel();
+
+        void start( Expirable& timer, std::chrono::nanoseconds timeout );
+        void stop( Expirable& timer );
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        static constexpr std::size_t levelBits = 6;
+        static constexpr std::size_t slotCount = 1 << levelBits;
+        static constexpr std::size_t levelCount = 6;
+
+        struct Level
+        {
+            std::array< Expirable*, slotCount > slots;
+            std::uint64_t occupied;
+        };
+
+        std::uint64_t currentTick() const;
+
+        void insert( Expirable& timer, std::uint64_t earliest );
+        void unlink( Expirable& timer );
+
+        bool nextTick( std::uint64_t& tick ) const;
+        void advance( std::uint64_t target );
+        void process( std::uint64_t tick );
+
+        void schedule();
+
+        asio::steady_timer timer_;
+        Clock::time_point origin_;
+        std::uint64_t now_;
+        std::array< Level, levelCount > levels_;
+        bool advancing_;
+        bool armed_;
+        std::uint64_t armedTick_;
+        std::size_t active_;
+        std::size_t started_;
+        std::size_t expired_;
+        std::size_t cascaded_;
+        std::size_t wakeups_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_TIMERWHEEL_HPP
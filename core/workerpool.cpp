@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <ostream>
+
+#include "core/logging.hpp"
+#include "core/workerpool.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static Logger logger( "workerpool" );
+
+    // the queue of the current thread, threads outside of the pool share the last one
+    static thread_local size_t currentQueue = numeric_limits< size_t >::max();
+
+    /**
+     * struct WorkerPool::Batch
+     */
+
+    struct WorkerPool::Batch
+    {
+        Invoke invoke;
+        void* body;
+        atomic< size_t > remaining;
+        mutex errorMutex;
+        exception_ptr error;
+    };
+
+    /**
+     * class WorkerPool
+     */
+
+    constexpr size_t WorkerPool::grain;
+
+    WorkerPool::WorkerPool( size_t threads )
+            : size_( threads )
+            , queues_( new Queue[ threads + 1 ] )
+            , queued_()
+            , stopping_()
+            , batches_()
+            , chunks_()
+            , steals_()
+    {
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            lock_guard< mutex > lock( mutex_ );
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for ( auto& thread : threads_ ) {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::start()
+    {
+        if ( size_ == 0 || !threads_.empty() ) {
+            return;
+        }
+
+        logger.info( "starting ", size_, " worker threads" );
+        threads_.reserve( size_ );
+        for ( size_t i = 0 ; i < size_ ; ++i ) {
+            threads_.emplace_back( [this, i] { work( i ); } );
+        }
+    }
+
+    void WorkerPool::statistics( ostream& os ) const
+    {
+        os << "\n\tWorkerPool : threads: " << threads_.size() << ", batches: " << batches_ << ", chunks: " << chunks_
+           << ", steals: " << steals_;
+    }
+
+    void WorkerPool::run( size_t count, size_t grain, Invoke invoke, void* body )
+    {
+        auto self = currentQueue < size_ ? currentQueue : size_;
+        auto chunks = ( count + grain - 1 ) / grain;
+
+        Batch batch;
+        batch.invoke = invoke;
+        batch.body = body;
+        batch.remaining = chunks;
+
+        // counted before they are queued, so that a waiting thread never misses them
+        queued_ += chunks;
+        {
+            auto& queue = queues_[ self ];
+            lock_guard< mutex > lock( queue.mutex );
+            for ( size_t first = 0 ; first < count ; first += grain ) {
+                queue.chunks.push_back( { &batch, first, min( first + grain, count ) } );
+            }
+        }
+        {
+            lock_guard< mutex > lock( mutex_ );
+        }
+        wakeup_.notify_all();
+
+        ++batches_;
+        chunks_ += chunks;
+
+        // work on any chunk while waiting, the ones of this batch may have been stolen by busy threads
+        Chunk chunk;
+        while ( batch.remaining.load( memory_order_acquire ) != 0 ) {
+            if ( take( self, chunk ) ) {
+                execute( chunk );
+            }
+            else {
+                this_thread::yield();
+            }
+        }
+
+        if ( batch.error ) {
+            rethrow_exception( batch.error );
+        }
+    }
+
+    void WorkerPool::work( size_t index )
+    {
+        currentQueue = index;
+
+        Chunk chunk;
+        for ( ;; ) {
+            if ( take( index, chunk ) ) {
+                execute( chunk );
+                continue;
+            }
+
+            unique_lock< mutex > lock( mutex_ );
+            wakeup_.wait( lock, [this] { return stopping_ || queued_ != 0; } );
+            if ( stopping_ ) {
+                return;
+            }
+        }
+    }
+
+    bool WorkerPool::take( size_t index, Chunk& chunk )
+    {
+        {
+            auto& queue = queues_[ index ];
+            lock_guard< mutex > lock( queue.mutex );
+            if ( !queue.chunks.empty() ) {
+                chunk = queue.chunks.back();
+                queue.chunks.pop_back();
+                --queued_;
+                return true;
+            }
+        }
+
+        for ( size_t i = 1 ; i <= size_ ; ++i ) {
+            auto& queue = queues_[ ( index + i ) % ( size_ + 1 ) ];
+            lock_guard< mutex > lock( queue.mutex );
+            if ( !queue.chunks.empty() ) {
+                chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+                --queued_;
+                ++steals_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerPool::execute( Chunk const& chunk )
+    {
+        auto batch = chunk.batch;
+        try {
+            batch->invoke( batch->body, chunk.first, chunk.last );
+        }
+        catch ( ... ) {
+            lock_guard< mutex > lock( batch->errorMutex );
+            if ( !batch->error ) {
+                batch->error = current_exception();
+            }
+        }
+        // the batch may be gone as soon as its last chunk is done
+        batch->remaining.fetch_sub( 1, memory_order_release );
+    }
+
+} // namespace sc
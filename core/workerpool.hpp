@@ -0,0 +1,102 @@
+#ifndef SCHLAZICONTROL_WORKERPOOL_HPP
+#define SCHLAZICONTROL_WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sc {
+
+    /**
+     * class WorkerPool
+     *
+     * Threads that help the IO thread render a frame. Work is handed out as chunks of an index range. Every thread
+     * takes chunks from its own queue first and steals from the other queues when it runs dry. The calling thread
+     * works on the chunks as well and returns only when all of them are done, so each call is a barrier. Without
+     * threads, or if the range fits into a single chunk, the work is done on the calling thread directly.
+     *
+     * The threads are started separately from construction, after the manager has forked its processes.
+     */
+
+    class WorkerPool
+    {
+    public:
+        // channels per chunk of the loops over a buffer, smaller buffers aren't worth splitting
+        static constexpr std::size_t grain = 4096;
+
+        explicit WorkerPool( std::size_t threads );
+        WorkerPool( WorkerPool const& ) = delete;
+        ~WorkerPool();
+
+        std::size_t threads() const { return threads_.size(); }
+
+        void start();
+
+        /**
+         * Calls body( first, last ) for consecutive chunks of at most grain indices that cover [0, count)
+         */
+        template< typename Body >
+        void parallelFor( std::size_t count, std::size_t grain, Body&& body )
+        {
+            if ( threads_.empty() || count <= grain ) {
+                body( std::size_t( 0 ), count );
+                return;
+            }
+            std::decay_t< Body > function( std::forward< Body >( body ) );
+            run( count, grain, &invoke< std::decay_t< Body > >, &function );
+        }
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        using Invoke = void ( * )( void* body, std::size_t first, std::size_t last );
+
+        struct Batch;
+
+        struct Chunk
+        {
+            Batch* batch;
+            std::size_t first;
+            std::size_t last;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque< Chunk > chunks;
+        };
+
+        template< typename Body >
+        static void invoke( void* body, std::size_t first, std::size_t last )
+        {
+            ( *static_cast< Body* >( body ) )( first, last );
+        }
+
+        void run( std::size_t count, std::size_t grain, Invoke invoke, void* body );
+        void work( std::size_t index );
+        bool take( std::size_t index, Chunk& chunk );
+        void execute( Chunk const& chunk );
+
+        std::size_t size_;
+        std::unique_ptr< Queue[] > queues_;
+        std::vector< std::thread > threads_;
+        std::mutex mutex_;
+        std::condition_variable wakeup_;
+        std::atomic< std::size_t > queued_;
+        bool stopping_;
+        std::atomic< std::size_t > batches_;
+        std::atomic< std::size_t > chunks_;
+        std::atomic< std::size_t > steals_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_WORKERPOOL_HPP
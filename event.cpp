@@ -12,25 +12,33 @@ namespace sc {
      */
 
     EventConnection::EventConnection()
+            : owner_()
+            , disconnect_()
+            , index_()
+            , generation_()
     {
     }
 
-    EventConnection::EventConnection( function< void () > disconnect )
-            : disconnect_( move( disconnect ) )
+    EventConnection::EventConnection( void* owner, Disconnect disconnect, size_t index, size_t generation )
+            : owner_( owner )
+            , disconnect_( disconnect )
+            , index_( index )
+            , generation_( generation )
     {
     }
 
     EventConnection& EventConnection::operator=( std::nullptr_t )
     {
-        disconnect_ = nullptr;
+        owner_ = nullptr;
         return *this;
     }
 
     void EventConnection::disconnect() const
     {
-        if ( disconnect_ ) {
-            disconnect_();
-            disconnect_ = nullptr;
+        if ( owner_ ) {
+            auto owner = owner_;
+            owner_ = nullptr;
+            disconnect_( owner, index_, generation_ );
         }
     }
 
@@ -2,15 +2,13 @@
 #define SCHLAZICONTROL_EVENT_HPP
 
 #include <algorithm>
-#include <functional>
-#include <list>
-#include <memory>
-#include <tuple>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
-#include <boost/iterator/iterator_adaptor.hpp>
-
-#include "scoped.hpp"
+#include "utility_function.hpp"
 
 namespace sc {
 
@@ -22,6 +20,8 @@ namespace sc {
     {
         template< typename Signature > friend class EventInterface;
 
+        using Disconnect = void ( * )( void* owner, std::size_t index, std::size_t generation );
+
     public:
         EventConnection();
 
@@ -30,9 +30,12 @@ namespace sc {
         void disconnect() const;
 
     private:
-        explicit EventConnection( std::function< void () > disconnect );
+        EventConnection( void* owner, Disconnect disconnect, std::size_t index, std::size_t generation );
 
-        mutable std::function< void () > disconnect_;
+        mutable void* owner_;
+        Disconnect disconnect_;
+        std::size_t index_;
+        std::size_t generation_;
     };
 
     /**
@@ -60,102 +63,168 @@ namespace sc {
 
     /**
      * class EventInterface
+     *
+     * Handlers are kept in a contiguous slot vector. A connection refers to its slot by index and generation, so
+     * disconnecting a handler only retires the slot and stale connections are ignored. Retired slots are released and
+     * handlers subscribed during a dispatch are added when the outermost dispatch is done, which keeps the slots in
+     * place while handlers run. Dispatching never allocates.
      */
 
-    namespace detail {
-        template< typename Signature > struct EventHandlerHolder;
-    } // namespace detail
-
     template< typename Signature >
     class EventInterface;
 
     template< typename ...Args >
     class EventInterface< void ( Args... ) >
     {
-        using Signature = void ( Args... );
         using ExtendedSignature = void ( EventConnection const&, Args... );
+        using Handler = InlineFunction< ExtendedSignature >;
 
-        using Holder = detail::EventHandlerHolder< Signature >;
-
-    public:
-        using Handler = std::function< Signature >;
-        using ExtendedHandler = std::function< ExtendedSignature >;
+        struct Slot
+        {
+            Handler handler;
+            std::size_t generation;
+            bool active;
+            bool oneShot;
+        };
 
-        EventConnection subscribe( ExtendedHandler handler )
+        class Lock
         {
-            auto guard = lock();
-            auto it = inserted_.emplace( handlers_.end() );
-            EventConnection connection( [this, it] { erase( it ); } );
-            *it = [handler, connection]( Args... args ) { handler( connection, args... ); };
-            return connection;
-        }
+        public:
+            explicit Lock( EventInterface& event ) : event_( event ) { ++event_.locked_; }
+            Lock( Lock const& ) = delete;
+            ~Lock() { if ( --event_.locked_ == 0 ) { event_.release(); } }
+
+        private:
+            EventInterface& event_;
+        };
 
-        EventConnection subscribe( Handler handler, bool oneShot = false )
+    public:
+        /**
+         * Subscribes a handler taking either the event's arguments or the connection followed by the arguments
+         */
+        template< typename Function >
+        EventConnection subscribe( Function&& handler, bool oneShot = false )
         {
-            auto guard = lock();
-            auto it = inserted_.emplace( handlers_.end() );
-            EventConnection connection( [this, it] { erase( it ); } );
-            *it = oneShot
-                  ? [handler, connection]( Args... args ) {
-                        EventScope scope( std::move( connection ) );
-                        handler( args... );
-                    }
-                  : std::move( handler );
-            return connection;
+            return insert(
+                    wrap( std::forward< Function >( handler ),
+                          IsCallable< std::decay_t< Function >&, ExtendedSignature >() ),
+                    oneShot );
         }
 
     protected:
+        bool empty() const { return subscribers_ == 0; }
+        std::size_t size() const { return subscribers_; }
+
+        /**
+         * Sets a handler that is called whenever the first handler subscribes to the event
+         */
+        void activation( InlineFunction< void () > handler ) { activation_ = std::move( handler ); }
+
         template< typename ...T >
         void operator()( T&&... args )
         {
-            auto guard = lock();
-            std::for_each(
-                    handlers_.begin(), handlers_.end(),
-                    [&args...]( Holder const& holder ) {
-                        if ( !holder.erased ) {
-                            holder.handler( std::forward< T >( args )... );
-                        }
-                    } );
+            Lock lock( *this );
+            auto size = slots_.size();
+            for ( std::size_t i = 0 ; i < size ; ++i ) {
+                auto& slot = slots_[ i ];
+                if ( slot.active ) {
+                    EventConnection connection( this, &disconnect, i, slot.generation );
+                    if ( slot.oneShot ) {
+                        retire( i );
+                    }
+                    slot.handler( connection, args... );
+                }
+            }
         };
 
     private:
-        Scoped lock()
+        template< typename Function >
+        static Handler wrap( Function&& handler, std::true_type )
         {
-            return Scoped(
-                    [this] { ++locked_; },
-                    [this] {
-                        if ( --locked_ == 0 ) {
-                            handlers_.remove_if( []( Holder& holder ) { return holder.erased; } );
-                            handlers_.splice( handlers_.end(), inserted_ );
-                        }
-                    } );
+            return Handler( std::forward< Function >( handler ) );
         }
 
-        void erase( typename std::list< Holder >::iterator it )
+        template< typename Function >
+        static Handler wrap( Function&& handler, std::false_type )
         {
-            auto guard = lock();
-            it->erased = true;
+            return Handler( [handler = std::forward< Function >( handler )]( EventConnection const&, Args... args ) mutable {
+                handler( std::forward< Args >( args )... );
+            } );
         }
 
-        std::list< Holder > handlers_;
-        std::list< Holder > inserted_;
-        std::size_t locked_ {};
-    };
+        static void disconnect( void* owner, std::size_t index, std::size_t generation )
+        {
+            auto& event = *static_cast< EventInterface* >( owner );
+            Lock lock( event );
+            if ( event.slot( index ).generation == generation ) {
+                event.retire( index );
+            }
+        }
 
-    namespace detail {
+        Slot& slot( std::size_t index )
+        {
+            return index < slots_.size() ? slots_[ index ] : pending_[ index - slots_.size() ];
+        }
 
-        template< typename Signature >
-        struct EventHandlerHolder
+        EventConnection insert( Handler&& handler, bool oneShot )
         {
-            using Handler = typename EventInterface< Signature >::Handler;
+            // make room for retiring every handler up front, so disconnecting doesn't allocate during a dispatch
+            auto capacity = slots_.size() + pending_.size() + 1;
+            retired_.reserve( capacity );
+            released_.reserve( capacity );
+
+            std::size_t index;
+            if ( locked_ > 0 ) {
+                index = slots_.size() + pending_.size();
+                pending_.push_back( { std::move( handler ), 0, true, oneShot } );
+            }
+            else if ( !released_.empty() ) {
+                index = released_.back();
+                released_.pop_back();
+                auto& slot = slots_[ index ];
+                slot.handler = std::move( handler );
+                slot.active = true;
+                slot.oneShot = oneShot;
+            }
+            else {
+                index = slots_.size();
+                slots_.push_back( { std::move( handler ), 0, true, oneShot } );
+            }
+            auto connection = EventConnection( this, &disconnect, index, slot( index ).generation );
+            if ( subscribers_++ == 0 && activation_ ) {
+                activation_();
+            }
+            return connection;
+        }
 
-            EventHandlerHolder& operator=( Handler&& handler ) { this->handler = std::move( handler ); return *this; }
+        void retire( std::size_t index )
+        {
+            auto& slot = this->slot( index );
+            slot.active = false;
+            ++slot.generation;
+            retired_.push_back( index );
+            --subscribers_;
+        }
 
-            Handler handler;
-            bool erased {};
-        };
+        void release()
+        {
+            std::move( pending_.begin(), pending_.end(), std::back_inserter( slots_ ) );
+            pending_.clear();
+            for ( auto index : retired_ ) {
+                slots_[ index ].handler = nullptr;
+                released_.push_back( index );
+            }
+            retired_.clear();
+        }
 
-    } // namespace detail
+        std::vector< Slot > slots_;
+        std::vector< Slot > pending_;
+        std::vector< std::size_t > retired_;
+        std::vector< std::size_t > released_;
+        std::size_t subscribers_ {};
+        std::size_t locked_ {};
+        InlineFunction< void () > activation_;
+    };
 
     /**
      * class Event
@@ -167,10 +236,12 @@ namespace sc {
     {
     public:
         using Interface = EventInterface< Signature >;
-        using typename Interface::Handler;
 
         Interface& interface() { return static_cast< Interface& >( *this ); }
 
+        using Interface::empty;
+        using Interface::size;
+        using Interface::activation;
         using Interface::operator();
     };
 
@@ -3,11 +3,13 @@
 #include <boost/spirit/include/phoenix_core.hpp>
 #include <boost/spirit/include/phoenix_operator.hpp>
 #include <boost/spirit/include/phoenix_fusion.hpp>
+#include <boost/spirit/include/phoenix_bind.hpp>
 #include <boost/spirit/include/phoenix_stl.hpp>
 #include <boost/spirit/include/qi.hpp>
 
 #include "expression.hpp"
 #include "core/logging.hpp"
+#include "formula.hpp"
 
 using CallArgument = sc::expression::detail::CallArgument;
 
@@ -113,6 +115,80 @@ namespace sc {
                 Rule< Call() > expression_;
             };
 
+            template< typename T >
+            struct FormulaNumberPolicies
+                    : qi::ureal_policies< T >
+            {
+                template< typename Iterator, typename Attribute >
+                static bool parse_nan( Iterator&, Iterator const&, Attribute& ) { return false; }
+
+                template< typename Iterator, typename Attribute >
+                static bool parse_inf( Iterator&, Iterator const&, Attribute& ) { return false; }
+            };
+
+            class FormulaGrammar
+                    : public qi::grammar< string::const_iterator, void(), ascii::space_type >
+            {
+                template< typename Signature > using Rule =
+                qi::rule< string::const_iterator, Signature, ascii::space_type >;
+                using CallRule =
+                qi::rule< string::const_iterator, qi::locals< string, size_t >, ascii::space_type >;
+
+            public:
+                explicit FormulaGrammar( FormulaBuilder& builder )
+                        : FormulaGrammar::base_type( expression_ )
+                {
+                    using qi::lexeme;
+                    using qi::lit;
+                    using qi::char_;
+                    using qi::eps;
+                    using ascii::alnum;
+                    using ascii::alpha;
+                    using namespace qi::labels;
+
+                    auto target = &builder;
+                    auto operation = [target]( Formula::Opcode opcode ) {
+                        return phoenix::bind( &FormulaBuilder::operation, target, opcode );
+                    };
+
+                    identifier_ %= lexeme[( alpha | char_( '_' ) ) >> *( alnum | char_( '_' ) )];
+
+                    call_ = identifier_[ _a = _1 ]
+                            >> lit( '(' )
+                            >> expression_[ _b = 1 ]
+                            >> *( lit( ',' ) >> expression_[ ++_b ] )
+                            >> lit( ')' )
+                            >> eps[ phoenix::bind( &FormulaBuilder::call, target, _a, _b ) ];
+
+                    primary_ = number_[ phoenix::bind( &FormulaBuilder::constant, target, _1 ) ]
+                            | call_
+                            | identifier_[ phoenix::bind( &FormulaBuilder::variable, target, _1 ) ]
+                            | ( lit( '(' ) >> expression_ >> lit( ')' ) );
+
+                    power_ = primary_ >> -( lit( '^' ) >> unary_ )[ operation( Formula::Opcode::power ) ];
+
+                    unary_ = ( lit( '-' ) >> unary_ )[ operation( Formula::Opcode::negate ) ]
+                            | power_;
+
+                    term_ = unary_ >> *( ( lit( '*' ) >> unary_ )[ operation( Formula::Opcode::multiply ) ]
+                                         | ( lit( '/' ) >> unary_ )[ operation( Formula::Opcode::divide ) ]
+                                         | ( lit( '%' ) >> unary_ )[ operation( Formula::Opcode::modulo ) ] );
+
+                    expression_ = term_ >> *( ( lit( '+' ) >> term_ )[ operation( Formula::Opcode::add ) ]
+                                              | ( lit( '-' ) >> term_ )[ operation( Formula::Opcode::subtract ) ] );
+                }
+
+            private:
+                qi::real_parser< double, FormulaNumberPolicies< double > > number_;
+                Rule< string() > identifier_;
+                CallRule call_;
+                Rule< void() > primary_;
+                Rule< void() > power_;
+                Rule< void() > unary_;
+                Rule< void() > term_;
+                Rule< void() > expression_;
+            };
+
             Call parseExpression( string const& text )
             {
                 auto first = text.begin();
@@ -137,6 +213,17 @@ namespace sc {
             return result;
         }
 
+        Formula parseFormula( string const& text )
+        {
+            FormulaBuilder builder;
+            auto first = text.begin();
+            auto last = text.end();
+            if ( !qi::phrase_parse( first, last, detail::FormulaGrammar( builder ), ascii::space ) || first != last ) {
+                throw runtime_error( str( "unable to parse formula \"", text, "\"" ) );
+            }
+            return builder.build();
+        }
+
     } // namespace expression
 
 } // namespace sc
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <chrono>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -16,6 +17,7 @@
 #include <boost/variant/variant.hpp>
 #include <typestring.hh>
 
+#include "formula.hpp"
 #include "typeinfo.hpp"
 #include "utility_stream.hpp"
 #include "utility_string.hpp"
@@ -390,6 +392,8 @@ namespace sc {
 
         std::chrono::nanoseconds parseDuration( std::string const& text );
 
+        Formula parseFormula( std::string const& text );
+
     } // namespace expression
 
 } // namespace sc
@@ -0,0 +1,249 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "formula.hpp"
+#include "utility_string.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    using Opcode = Formula::Opcode;
+
+    static constexpr uint8_t maxRegisters = 255;
+    static constexpr uint8_t temporaryBase = 128;
+
+    template< typename Visitor >
+    static auto dispatch( Opcode opcode, Visitor&& visitor )
+    {
+        switch ( opcode ) {
+            case Opcode::add: return visitor( []( double a, double b, double ) { return a + b; } );
+            case Opcode::subtract: return visitor( []( double a, double b, double ) { return a - b; } );
+            case Opcode::multiply: return visitor( []( double a, double b, double ) { return a * b; } );
+            case Opcode::divide: return visitor( []( double a, double b, double ) { return b != 0.0 ? a / b : 0.0; } );
+            case Opcode::modulo: return visitor( []( double a, double b, double ) { return b != 0.0 ? fmod( a, b ) : 0.0; } );
+            case Opcode::power: return visitor( []( double a, double b, double ) { return pow( a, b ); } );
+            case Opcode::negate: return visitor( []( double a, double, double ) { return -a; } );
+            case Opcode::sin: return visitor( []( double a, double, double ) { return sin( a ); } );
+            case Opcode::cos: return visitor( []( double a, double, double ) { return cos( a ); } );
+            case Opcode::abs: return visitor( []( double a, double, double ) { return fabs( a ); } );
+            case Opcode::floor: return visitor( []( double a, double, double ) { return floor( a ); } );
+            case Opcode::frac: return visitor( []( double a, double, double ) { return a - floor( a ); } );
+            case Opcode::sqrt: return visitor( []( double a, double, double ) { return a > 0.0 ? sqrt( a ) : 0.0; } );
+            case Opcode::min: return visitor( []( double a, double b, double ) { return a < b ? a : b; } );
+            case Opcode::max: return visitor( []( double a, double b, double ) { return a > b ? a : b; } );
+            case Opcode::clamp: return visitor( []( double a, double b, double c ) { return a < b ? b : a > c ? c : a; } );
+        }
+        throw invalid_argument( "invalid enum constant for Formula::Opcode" );
+    }
+
+    /**
+     * class Formula
+     */
+
+    constexpr size_t Formula::blockSize;
+
+    Formula::Formula()
+            : registers_( variableCount )
+            , result_()
+            , used_()
+    {
+    }
+
+    void Formula::prepare( vector< double >& scratch ) const
+    {
+        scratch.assign( registers_ * blockSize, 0.0 );
+        for ( size_t i = 0 ; i < constants_.size() ; ++i ) {
+            fill_n( &scratch[ ( variableCount + i ) * blockSize ], blockSize, constants_[ i ] );
+        }
+    }
+
+    void Formula::evaluate( vector< double >& scratch, double const* values, size_t first, size_t size,
+                            size_t count, double time, double* result ) const
+    {
+        auto reg = [&scratch]( size_t index ) { return &scratch[ index * blockSize ]; };
+
+        if ( uses( index ) ) {
+            auto target = reg( index );
+            for ( size_t k = 0 ; k < size ; ++k ) {
+                target[ k ] = (double) ( first + k );
+            }
+        }
+        if ( uses( Formula::count ) ) {
+            fill_n( reg( Formula::count ), size, (double) count );
+        }
+        if ( uses( Formula::time ) ) {
+            fill_n( reg( Formula::time ), size, time );
+        }
+        if ( uses( value ) ) {
+            copy_n( values + first, size, reg( value ) );
+        }
+
+        for ( auto const& instruction : code_ ) {
+            auto target = reg( instruction.target );
+            auto a = reg( instruction.operands[ 0 ] );
+            auto b = reg( instruction.operands[ 1 ] );
+            auto c = reg( instruction.operands[ 2 ] );
+            dispatch( instruction.opcode, [=]( auto operation ) {
+                for ( size_t k = 0 ; k < size ; ++k ) {
+                    target[ k ] = operation( a[ k ], b[ k ], c[ k ] );
+                }
+            } );
+        }
+
+        copy_n( reg( result_ ), size, result );
+    }
+
+    /**
+     * class FormulaBuilder
+     */
+
+    FormulaBuilder::FormulaBuilder()
+            : temporaries_()
+    {
+    }
+
+    void FormulaBuilder::constant( double value )
+    {
+        stack_.push_back( { true, value, 0 } );
+    }
+
+    void FormulaBuilder::variable( string const& name )
+    {
+        Formula::Variable variable;
+        if ( name == "i" ) {
+            variable = Formula::index;
+        }
+        else if ( name == "n" ) {
+            variable = Formula::count;
+        }
+        else if ( name == "t" ) {
+            variable = Formula::time;
+        }
+        else if ( name == "v" ) {
+            variable = Formula::value;
+        }
+        else if ( name == "pi" ) {
+            constant( M_PI );
+            return;
+        }
+        else {
+            throw runtime_error( str( "unknown variable \"", name, "\" in formula" ) );
+        }
+        formula_.used_ |= 1u << variable;
+        stack_.push_back( { false, 0.0, variable } );
+    }
+
+    void FormulaBuilder::operation( Formula::Opcode opcode )
+    {
+        emit( opcode, opcode == Opcode::negate ? 1 : 2 );
+    }
+
+    void FormulaBuilder::call( string const& name, size_t arguments )
+    {
+        static pair< char const*, pair< Opcode, size_t > > const functions[] = {
+                { "sin", { Opcode::sin, 1 } },
+                { "cos", { Opcode::cos, 1 } },
+                { "abs", { Opcode::abs, 1 } },
+                { "floor", { Opcode::floor, 1 } },
+                { "frac", { Opcode::frac, 1 } },
+                { "sqrt", { Opcode::sqrt, 1 } },
+                { "min", { Opcode::min, 2 } },
+                { "max", { Opcode::max, 2 } },
+                { "pow", { Opcode::power, 2 } },
+                { "clamp", { Opcode::clamp, 3 } }
+        };
+
+        auto it = find_if( begin( functions ), end( functions ),
+                           [&name]( auto const& entry ) { return name == entry.first; } );
+        if ( it == end( functions ) ) {
+            throw runtime_error( str( "unknown function ", name, " in formula" ) );
+        }
+        if ( it->second.second != arguments ) {
+            throw runtime_error( str( "invalid number of arguments to function ", name, " (expected ",
+                                      it->second.second, " but was ", arguments, ")" ) );
+        }
+        emit( it->second.first, arguments );
+    }
+
+    Formula FormulaBuilder::build()
+    {
+        if ( stack_.size() != 1 ) {
+            throw runtime_error( "formula does not evaluate to a single value" );
+        }
+
+        auto result = materialize( stack_.back() );
+        auto constants = formula_.constants_.size();
+        if ( Formula::variableCount + constants + temporaries_ > maxRegisters ) {
+            throw runtime_error( "formula too complex" );
+        }
+
+        // temporaries are numbered from temporaryBase while building, move them behind the constants
+        auto relocate = [constants]( uint8_t reg ) {
+            return reg < temporaryBase ? reg : (uint8_t) ( Formula::variableCount + constants + reg - temporaryBase );
+        };
+        for ( auto& instruction : formula_.code_ ) {
+            instruction.target = relocate( instruction.target );
+            for ( auto& operand : instruction.operands ) {
+                operand = relocate( operand );
+            }
+        }
+        formula_.result_ = relocate( result );
+        formula_.registers_ = Formula::variableCount + constants + temporaries_;
+        return move( formula_ );
+    }
+
+    uint8_t FormulaBuilder::materialize( Operand const& operand )
+    {
+        if ( !operand.constant ) {
+            return operand.reg;
+        }
+
+        auto& constants = formula_.constants_;
+        auto it = find( constants.begin(), constants.end(), operand.value );
+        if ( it == constants.end() ) {
+            if ( Formula::variableCount + constants.size() >= temporaryBase ) {
+                throw runtime_error( "formula too complex" );
+            }
+            it = constants.insert( it, operand.value );
+        }
+        return (uint8_t) ( Formula::variableCount + distance( constants.begin(), it ) );
+    }
+
+    void FormulaBuilder::emit( Formula::Opcode opcode, size_t arity )
+    {
+        if ( stack_.size() < arity ) {
+            throw runtime_error( "malformed formula" );
+        }
+
+        auto first = prev( stack_.end(), arity );
+        if ( all_of( first, stack_.end(), []( Operand const& operand ) { return operand.constant; } ) ) {
+            double operands[ 3 ] {};
+            transform( first, stack_.end(), operands, []( Operand const& operand ) { return operand.value; } );
+            auto value = dispatch( opcode, [&operands]( auto operation ) {
+                return operation( operands[ 0 ], operands[ 1 ], operands[ 2 ] );
+            } );
+            stack_.erase( first, stack_.end() );
+            constant( value );
+            return;
+        }
+
+        auto depth = stack_.size() - arity;
+        if ( temporaryBase + depth >= maxRegisters ) {
+            throw runtime_error( "formula too complex" );
+        }
+
+        Formula::Instruction instruction { opcode, (uint8_t) ( temporaryBase + depth ), {} };
+        transform( first, stack_.end(), instruction.operands,
+                   [this]( Operand const& operand ) { return materialize( operand ); } );
+        fill( next( instruction.operands, arity ), end( instruction.operands ), instruction.operands[ 0 ] );
+        formula_.code_.push_back( instruction );
+
+        stack_.erase( first, stack_.end() );
+        stack_.push_back( { false, 0.0, instruction.target } );
+        temporaries_ = max( temporaries_, depth + 1 );
+    }
+
+} // namespace sc
@@ -0,0 +1,109 @@
+#ifndef SCHLAZICONTROL_FORMULA_HPP
+#define SCHLAZICONTROL_FORMULA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sc {
+
+    /**
+     * class Formula
+     *
+     * An arithmetic formula compiled into register bytecode. Every register holds one value per channel of a block,
+     * so each instruction is a tight loop over the block and the dispatch cost is paid once per block instead of
+     * once per channel. Constant subexpressions are folded at compile time.
+     */
+
+    class Formula
+    {
+        friend class FormulaBuilder;
+
+    public:
+        enum Variable : std::uint8_t
+        {
+            index,      // i: channel index
+            count,      // n: channel count
+            time,       // t: seconds since the formula started running
+            value,      // v: input value of the channel, 0..1
+            variableCount
+        };
+
+        enum class Opcode : std::uint8_t
+        {
+            add, subtract, multiply, divide, modulo, power, negate,
+            sin, cos, abs, floor, frac, sqrt, min, max, clamp
+        };
+
+        struct Instruction
+        {
+            Opcode opcode;
+            std::uint8_t target;
+            std::uint8_t operands[ 3 ];
+        };
+
+        static constexpr std::size_t blockSize = 64;
+
+        Formula();
+
+        bool uses( Variable variable ) const { return ( used_ & ( 1u << variable ) ) != 0; }
+        std::size_t instructions() const { return code_.size(); }
+        std::size_t registers() const { return registers_; }
+
+        /**
+         * Prepares a scratch area of registers() * blockSize values to be passed to evaluate()
+         */
+        void prepare( std::vector< double >& scratch ) const;
+
+        /**
+         * Evaluates the formula for the channels [first, first + size), size <= blockSize
+         */
+        void evaluate( std::vector< double >& scratch, double const* values, std::size_t first, std::size_t size,
+                       std::size_t count, double time, double* result ) const;
+
+    private:
+        std::vector< Instruction > code_;
+        std::vector< double > constants_;
+        std::size_t registers_;
+        std::uint8_t result_;
+        unsigned used_;
+    };
+
+    /**
+     * class FormulaBuilder
+     *
+     * Receives the formula in postfix order from the parser and emits the bytecode.
+     */
+
+    class FormulaBuilder
+    {
+    public:
+        FormulaBuilder();
+
+        void constant( double value );
+        void variable( std::string const& name );
+        void operation( Formula::Opcode opcode );
+        void call( std::string const& name, std::size_t arguments );
+
+        Formula build();
+
+    private:
+        struct Operand
+        {
+            bool constant;
+            double value;
+            std::uint8_t reg;
+        };
+
+        std::uint8_t materialize( Operand const& operand );
+        void emit( Formula::Opcode opcode, std::size_t arity );
+
+        Formula formula_;
+        std::vector< Operand > stack_;
+        std::size_t temporaries_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_FORMULA_HPP
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+
+#include "fusion.hpp"
+#include "types.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * class FusionKernel
+     */
+
+    constexpr size_t FusionKernel::unmapped;
+
+    FusionKernel::FusionKernel( size_t channels )
+            : inputChannels_( channels )
+            , sources_( channels )
+    {
+        iota( sources_.begin(), sources_.end(), 0 );
+    }
+
+    void FusionKernel::shift( size_t offset )
+    {
+        sources_.insert( sources_.begin(), offset, unmapped );
+        if ( !colors_.empty() ) {
+            colors_.insert( colors_.begin(), offset, 0.0 );
+        }
+    }
+
+    void FusionKernel::repeat( size_t factor )
+    {
+        auto size = sources_.size();
+        sources_.reserve( size * factor );
+        colors_.reserve( colors_.size() * factor );
+        for ( size_t i = 1 ; i < factor ; ++i ) {
+            copy_n( sources_.begin(), size, back_inserter( sources_ ) );
+            if ( !colors_.empty() ) {
+                copy_n( colors_.begin(), size, back_inserter( colors_ ) );
+            }
+        }
+    }
+
+    void FusionKernel::gather( vector< size_t > const& table )
+    {
+        vector< size_t > sources( table.size() );
+        vector< double > colors( colors_.empty() ? 0 : table.size() );
+        for ( size_t i = 0 ; i < table.size() ; ++i ) {
+            auto mapped = table[ i ] != unmapped;
+            sources[ i ] = mapped ? sources_[ table[ i ] ] : unmapped;
+            if ( !colors.empty() ) {
+                colors[ i ] = mapped ? colors_[ table[ i ] ] : 0.0;
+            }
+        }
+        sources_ = move( sources );
+        colors_ = move( colors );
+    }
+
+    bool FusionKernel::colorize( vector< Rgb > const& colors )
+    {
+        // colouring quantizes to 8 bits, which only composes with stages that don't change the values
+        if ( !colors_.empty() || colors.size() != sources_.size() ) {
+            return false;
+        }
+
+        vector< size_t > sources( sources_.size() * 3 );
+        colors_.resize( sources.size() );
+        for ( size_t i = 0 ; i < sources_.size() ; ++i ) {
+            fill_n( &sources[ i * 3 ], 3, sources_[ i ] );
+            colors_[ i * 3 ] = colors[ i ].red();
+            colors_[ i * 3 + 1 ] = colors[ i ].green();
+            colors_[ i * 3 + 2 ] = colors[ i ].blue();
+        }
+        sources_ = move( sources );
+        return true;
+    }
+
+    void FusionKernel::apply( ChannelBuffer const& input, ChannelBuffer& output, size_t first, size_t last ) const
+    {
+        if ( colors_.empty() ) {
+            for ( size_t i = first ; i < last ; ++i ) {
+                output[ i ] = sources_[ i ] != unmapped ? input[ sources_[ i ] ] : ChannelValue();
+            }
+            return;
+        }
+
+        // same arithmetic as Rgb::scale() so that the result matches the unfused transitions exactly
+        for ( size_t i = first ; i < last ; ++i ) {
+            auto source = sources_[ i ];
+            auto factor = source != unmapped ? RangedUnit< double >( input[ source ] ).get() : 0.0;
+            output[ i ] = RangedType< uint8_t >( (uint8_t) ( (uint8_t) colors_[ i ] * factor ) );
+        }
+    }
+
+} // namespace sc
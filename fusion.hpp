@@ -0,0 +1,52 @@
+#ifndef SCHLAZICONTROL_FUSION_HPP
+#define SCHLAZICONTROL_FUSION_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "forward.hpp"
+#include "utility_graphics.hpp"
+
+namespace sc {
+
+    /**
+     * class FusionKernel
+     *
+     * The combined effect of a chain of stateless transitions that only move channels around and colour them. Every
+     * output channel is described by the input channel it is read from and a colour gain, so the whole chain runs as
+     * a single pass that reads each input channel once and writes each output channel once.
+     */
+
+    class FusionKernel
+    {
+    public:
+        static constexpr std::size_t unmapped = std::numeric_limits< std::size_t >::max();
+
+        explicit FusionKernel( std::size_t channels );
+
+        std::size_t inputChannels() const { return inputChannels_; }
+        std::size_t outputChannels() const { return sources_.size(); }
+
+        /**
+         * Composition of the stages, each of them applied to the output of the kernel so far
+         */
+        void shift( std::size_t offset );
+        void repeat( std::size_t factor );
+        void gather( std::vector< std::size_t > const& table );
+        bool colorize( std::vector< Rgb > const& colors );
+
+        /**
+         * Computes the output channels [first, last), disjoint ranges may be computed concurrently
+         */
+        void apply( ChannelBuffer const& input, ChannelBuffer& output, std::size_t first, std::size_t last ) const;
+
+    private:
+        std::size_t inputChannels_;
+        std::vector< std::size_t > sources_;
+        std::vector< double > colors_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_FUSION_HPP
@@ -1,8 +1,10 @@
 #include <csignal>
 #include <cstdint>
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iterator>
+#include <memory>
 #include <ostream>
 #include <ratio>
 #include <utility>
@@ -14,7 +16,9 @@
 
 #include "core/logging.hpp"
 #include "core/manager.hpp"
+#include "core/properties.hpp"
 #include "modules/rpi_ws281x/ws281x.hpp"
+#include "powerlimit.hpp"
 #include "types.hpp"
 #include "utility_gamma.hpp"
 
@@ -222,6 +226,38 @@ namespace sc {
 
 	static PropertyKey const gpioPinProperty( "gpioPin" );
 	static PropertyKey const ledCountProperty( "ledCount" );
+	static PropertyKey const powerProperty( "power" );
+
+	/**
+	 * class Ws281x
+	 */
+
+	Ws281x::Ws281x( string&& id, PropertyNode const& properties )
+			: Component( move( id ))
+			, powerLimit_( properties.has( powerProperty.name() )
+						   ? make_unique< PowerLimit >( properties[ powerProperty ] ) : nullptr ) {}
+
+	Ws281x::~Ws281x() = default;
+
+	vector< uint8_t > const& Ws281x::dutyCycles( ChannelBuffer const& values )
+	{
+		// the budget applies to what the LEDs actually get, so it is checked after the gamma correction
+		dutyCycles_.resize( values.size() );
+		std::transform( values.begin(), values.end(), dutyCycles_.begin(), []( ChannelValue const& value ) {
+			return GammaTable< ratio< 10, 25 > >::get( RangedType< std::uint8_t >( value ).get() );
+		} );
+		if ( powerLimit_ ) {
+			powerLimit_->limit( dutyCycles_.data(), dutyCycles_.size() );
+		}
+		return dutyCycles_;
+	}
+
+	void Ws281x::limitStatistics( ostream& os ) const
+	{
+		if ( powerLimit_ ) {
+			os << ", power: " << makeStatistics( *powerLimit_ );
+		}
+	}
 
 	/**
 	 * class Ws281xDirect
@@ -232,7 +268,7 @@ namespace sc {
 	{
 	public:
 		Ws281xDirect( string&& id, Manager& manager, PropertyNode const& properties )
-				: Ws281x( move( id ))
+				: Ws281x( move( id ), properties )
 				, wrapper_( properties[ gpioPinProperty ].as< uint16_t >(),
 							properties[ ledCountProperty ].as< size_t >()) {}
 
@@ -240,20 +276,24 @@ namespace sc {
 
 		void send( ChannelBuffer const& values ) override
 		{
-			assert( values.size() == wrapper_->ledCount() * 3 );
+			assert( values.size() == wrapper_.ledCount() * 3 );
 
+			auto const& dutyCycles = this->dutyCycles( values );
 			auto dstIt = wrapper_.pixels();
-			for ( auto it = values.cbegin() ; it != values.cend() ; ) {
-				uint8_t r = GammaTable< ratio< 10, 25 > >::get( RangedType< std::uint8_t >( *it++ ).get() );
-				uint8_t g = GammaTable< ratio< 10, 25 > >::get( RangedType< std::uint8_t >( *it++ ).get() );
-				uint8_t b = GammaTable< ratio< 10, 25 > >::get( RangedType< std::uint8_t >( *it++ ).get() );
+			for ( auto it = dutyCycles.cbegin() ; it != dutyCycles.cend() ; ) {
+				uint8_t r = *it++;
+				uint8_t g = *it++;
+				uint8_t b = *it++;
 				*dstIt++ = ( r << 16 ) | ( g << 8 ) | b;
 			}
 			wrapper_.update();
 		}
 
 	protected:
-		void doStatistics( std::ostream& os ) const override {}
+		void doStatistics( std::ostream& os ) const override
+		{
+			limitStatistics( os );
+		}
 
 	private:
 		Ws281xWrapper wrapper_;
@@ -269,7 +309,7 @@ namespace sc {
 	{
 	public:
 		Ws281xClient( string&& id, Manager& manager, PropertyNode const& properties )
-				: Ws281x( move( id ))
+				: Ws281x( move( id ), properties )
 				, manager_( manager )
 				, gpioPin_( properties[ gpioPinProperty ].as< uint16_t >())
 				, ledCount_( properties[ ledCountProperty ].as< size_t >())
@@ -296,8 +336,7 @@ namespace sc {
 			}
 
 			ostream os( &outgoing_ );
-			for ( auto const& it : values ) {
-				uint8_t value = GammaTable< ratio< 10, 25 > >::get( RangedType< std::uint8_t >( it ).get() );
+			for ( auto value : dutyCycles( values ) ) {
 				os << setw( 2 ) << setfill( '0' ) << hex << (unsigned) value;
 			}
 			os << ws281xSeparator << flush;
@@ -309,6 +348,7 @@ namespace sc {
 		void doStatistics( std::ostream& os ) const override
 		{
 			os << ", connected: " << socket_.is_open();
+			limitStatistics( os );
 		}
 
 	private:
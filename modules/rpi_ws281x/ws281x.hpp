@@ -2,12 +2,21 @@
 #define SCHLAZICONTROL_WS281X_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "core/component.hpp"
 #include "forward.hpp"
+#include "types.hpp"
 
 namespace sc {
 
+    class PowerLimit;
+    class PropertyNode;
+
     /**
      * class Ws281x
      */
@@ -16,12 +25,24 @@ namespace sc {
 		: public Component
 	{
 	public:
-		explicit Ws281x( std::string&& id )
-				: Component( std::move( id )) {}
+		Ws281x( std::string&& id, PropertyNode const& properties );
+		~Ws281x();
 
 		virtual std::size_t ledCount() const = 0;
 
 		virtual void send( ChannelBuffer const& values ) = 0;
+
+	protected:
+		/**
+		 * Returns the gamma corrected duty cycles of all channels, scaled down to the power budget if there is one
+		 */
+		std::vector< std::uint8_t > const& dutyCycles( ChannelBuffer const& values );
+
+		void limitStatistics( std::ostream& os ) const;
+
+	private:
+		std::unique_ptr< PowerLimit > powerLimit_;
+		std::vector< std::uint8_t > dutyCycles_;
 	};
 
 } // namespace sc
@@ -1,16 +1,65 @@
 #include <algorithm>
+#include <stdexcept>
 #include <utility>
 
 #include "core/manager.hpp"
 #include "multiconnection.hpp"
 #include "core/properties.hpp"
-#include "utility_stream.hpp"
+#include "utility_math.hpp"
+#include "utility_string.hpp"
 
 using namespace std;
 
 namespace sc {
 
     static PropertyKey const inputsProperty( "inputs" );
+    static PropertyKey const blendProperty( "blend", "max" );
+    static PropertyKey const opacitiesProperty( "opacities" );
+
+    static MultiConnection::Blend parseBlend( string const& name )
+    {
+        if ( name == "max" ) {
+            return MultiConnection::Blend::max;
+        }
+        if ( name == "add" ) {
+            return MultiConnection::Blend::add;
+        }
+        if ( name == "multiply" ) {
+            return MultiConnection::Blend::multiply;
+        }
+        if ( name == "over" ) {
+            return MultiConnection::Blend::over;
+        }
+        throw runtime_error( str( "unknown blend mode \"", name, "\"" ) );
+    }
+
+    static char const* blendName( MultiConnection::Blend blend )
+    {
+        switch ( blend ) {
+            case MultiConnection::Blend::max: return "max";
+            case MultiConnection::Blend::add: return "add";
+            case MultiConnection::Blend::multiply: return "multiply";
+            case MultiConnection::Blend::over: return "over";
+        }
+        throw invalid_argument( "invalid enum constant for MultiConnection::Blend" );
+    }
+
+    // finds the span [first, last) of channels in which two buffers differ
+    static pair< size_t, size_t > changedSpan( ChannelBuffer const& a, ChannelBuffer const& b )
+    {
+        if ( a.size() != b.size() ) {
+            return { 0, max( a.size(), b.size() ) };
+        }
+        size_t first = 0;
+        size_t last = a.size();
+        while ( first < last && a[ first ] == b[ first ] ) {
+            ++first;
+        }
+        while ( last > first && a[ last - 1 ] == b[ last - 1 ] ) {
+            --last;
+        }
+        return { first, last };
+    }
 
     MultiConnection::MultiConnection( string&& id, Manager& manager, PropertyNode const& properties )
             : Component( move( id ) )
@@ -20,33 +69,104 @@ namespace sc {
                             inputs().begin(), inputs().end(),
                             []( auto const& a, auto const& b ) { return a->emitsChannels() < b->emitsChannels(); } )
                     )->emitsChannels() )
+            , blend_( parseBlend( properties[ blendProperty ].as< string >() ) )
             , values_( channels_ )
+            , layers_( inputs().size(), Layer { ChannelBuffer(), 1.0, false, false } )
     {
+        if ( properties.has( opacitiesProperty.name() ) ) {
+            auto opacities = properties[ opacitiesProperty ].as< vector< double > >();
+            if ( opacities.size() != layers_.size() ) {
+                throw runtime_error( str( "invalid opacities in component ", describe(), ": expected ",
+                                          layers_.size(), " values but got ", opacities.size() ) );
+            }
+            for ( size_t i = 0 ; i < layers_.size() ; ++i ) {
+                layers_[ i ].opacity = clip( opacities[ i ], 0.0, 1.0 );
+            }
+        }
     }
 
-    void MultiConnection::set( Input const& input, ChannelBuffer const& values )
+    void MultiConnection::setInput( size_t index, Input const& input, ChannelBuffer const& values )
     {
-        buffers_[ input.id() ] = values;
-
-        values_.fill();
-        for_each( buffers_.cbegin(), buffers_.cend(),
-                  [this]( auto const& entry ) {
-                      transform( entry.second.cbegin(), entry.second.cend(), values_.begin(), values_.begin(),
-                                 []( auto const& a, auto const& b ) {
-                                     return ChannelValue( max( a.get(), b.get() ) );
-                                 } );
-                  } );
+        auto& layer = layers_[ index ];
+
+        auto span = layer.received ? changedSpan( layer.values, values ) : make_pair( size_t(), values.size() );
+        if ( blend_ == Blend::over ) {
+            // a layer that is completely off lets the layers below it show through
+            auto visible = any_of( values.begin(), values.end(), []( ChannelValue const& value ) { return value.on(); } );
+            if ( visible != layer.visible ) {
+                span = { 0, values.size() };
+                layer.visible = visible;
+            }
+        }
+        layer.values = values;
+        layer.received = true;
+
+        span.second = min( span.second, channels_ );
+        if ( span.first >= span.second ) {
+            return;
+        }
+
+        merge( span.first, span.second );
         inputChangeEvent_( values_ );
     }
 
+    void MultiConnection::merge( size_t first, size_t last )
+    {
+        static constexpr double full = ChannelValue::maximum;
+
+        merged_.assign( last - first, 0.0 );
+        auto merged = merged_.data();
+        auto base = true;
+        for ( auto const& layer : layers_ ) {
+            if ( !layer.received || ( blend_ == Blend::over && !layer.visible ) ) {
+                continue;
+            }
+
+            auto size = min( last, layer.values.size() );
+            if ( size <= first ) {
+                continue;
+            }
+            size -= first;
+
+            auto const& src = layer.values;
+            auto opacity = layer.opacity;
+            switch ( base && blend_ == Blend::multiply ? Blend::over : blend_ ) {
+                case Blend::max:
+                    for ( size_t k = 0 ; k < size ; ++k ) {
+                        merged[ k ] = max( merged[ k ], src[ first + k ].get() * opacity );
+                    }
+                    break;
+                case Blend::add:
+                    for ( size_t k = 0 ; k < size ; ++k ) {
+                        merged[ k ] = min( full, merged[ k ] + src[ first + k ].get() * opacity );
+                    }
+                    break;
+                case Blend::multiply:
+                    for ( size_t k = 0 ; k < size ; ++k ) {
+                        merged[ k ] *= 1.0 - opacity + opacity * src[ first + k ].get() / full;
+                    }
+                    break;
+                case Blend::over:
+                    for ( size_t k = 0 ; k < size ; ++k ) {
+                        merged[ k ] += ( src[ first + k ].get() - merged[ k ] ) * opacity;
+                    }
+                    break;
+            }
+            base = false;
+        }
+
+        for ( size_t k = 0 ; k < merged_.size() ; ++k ) {
+            values_[ first + k ] = ChannelValue( merged[ k ] );
+        }
+    }
+
     void MultiConnection::doStatistics( ostream& os ) const
     {
-        os << ", channels: " << channels_ << ", buffers: " << buffers_.size()
+        os << ", channels: " << channels_ << ", blend: " << blendName( blend_ )
            << "\n\t\tvalues: " << makeStatistics( values_ );
-        transform( buffers_.begin(), buffers_.end(), OutputStreamIterator( os ),
-                   []( auto const& entry ) {
-                       return make_tuple( "\n\t\tbuffer[", ref( entry.first ), "]: ", makeStatistics( entry.second ) );
-                   } );
+        for ( size_t i = 0 ; i < layers_.size() ; ++i ) {
+            os << "\n\t\tlayer[" << inputs()[ i ]->id() << "]: " << makeStatistics( layers_[ i ].values );
+        }
     }
 
     static ComponentRegistry< MultiConnection > registry( "multiconnection" );
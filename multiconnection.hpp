@@ -1,7 +1,7 @@
 #ifndef SCHLAZICONTROL_MULTICONNECTION_HPP
 #define SCHLAZICONTROL_MULTICONNECTION_HPP
 
-#include <unordered_map>
+#include <vector>
 
 #include "core/input.hpp"
 #include "core/output.hpp"
@@ -12,25 +12,52 @@ namespace sc {
     class Manager;
     class PropertyNode;
 
+    /**
+     * class MultiConnection
+     *
+     * Layers the buffers of several inputs onto one. The inputs are blended in the order they are listed, so later
+     * inputs have higher priority. Only the channels that actually changed in an update are merged again.
+     */
+
     class MultiConnection final
             : public Output
             , public Input
     {
     public:
+        enum class Blend
+        {
+            max, add, multiply, over
+        };
+
         MultiConnection( std::string&& id, Manager& manager, PropertyNode const& properties );
 
         virtual bool acceptsChannels( std::size_t channels ) const override { return true; }
         virtual std::size_t emitsChannels() const override { return channels_; }
+        virtual std::size_t rank() const override { return inputRank(); }
 
     protected:
-        virtual void set( Input const& input, ChannelBuffer const& values ) override;
+        // never called, the inputs are told apart by their index in setInput()
+        virtual void set( Input const& input, ChannelBuffer const& values ) override {}
+        virtual void setInput( std::size_t index, Input const& input, ChannelBuffer const& values ) override;
 
         virtual void doStatistics( std::ostream& os ) const override;
 
     private:
+        struct Layer
+        {
+            ChannelBuffer values;
+            double opacity;
+            bool received;
+            bool visible;
+        };
+
+        void merge( std::size_t first, std::size_t last );
+
         std::size_t channels_;
+        Blend blend_;
         ChannelBuffer values_;
-        std::unordered_map< std::string, ChannelBuffer > buffers_;
+        std::vector< Layer > layers_;
+        std::vector< double > merged_;
     };
 
 } // namespace sc
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+#include "core/properties.hpp"
+#include "powerlimit.hpp"
+#include "types.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static double sumChannels( ChannelBuffer const& values )
+    {
+        // independent partial sums keep the additions free of a loop-carried dependency so they can be vectorised
+        double sums[ 4 ] {};
+        auto it = values.cbegin();
+        auto size = values.size();
+        size_t i = 0;
+        for ( ; i + 4 <= size ; i += 4 ) {
+            sums[ 0 ] += ( it++ )->get();
+            sums[ 1 ] += ( it++ )->get();
+            sums[ 2 ] += ( it++ )->get();
+            sums[ 3 ] += ( it++ )->get();
+        }
+        for ( ; i < size ; ++i ) {
+            sums[ 0 ] += ( it++ )->get();
+        }
+        return ( sums[ 0 ] + sums[ 1 ] ) + ( sums[ 2 ] + sums[ 3 ] );
+    }
+
+    static double sumDutyCycles( uint8_t const* dutyCycles, size_t size )
+    {
+        // integer sums are exact in any order, so the compiler vectorises the plain loop
+        uint64_t sum = 0;
+        for ( size_t i = 0 ; i < size ; ++i ) {
+            sum += dutyCycles[ i ];
+        }
+        return (double) sum / numeric_limits< uint8_t >::max();
+    }
+
+    /**
+     * class PowerLimit
+     */
+
+    static PropertyKey const budgetProperty( "budget" );
+    static PropertyKey const channelCurrentProperty( "channelCurrent", 20 );
+    static PropertyKey const releaseProperty( "release", "1s" );
+
+    PowerLimit::PowerLimit( PropertyNode const& properties )
+            : budget_( properties[ budgetProperty ].as< double >() )
+            , channelCurrent_( properties[ channelCurrentProperty ].as< double >() )
+            , releasePerNs_( 1.0 / max< chrono::nanoseconds::rep >(
+                    properties[ releaseProperty ].as< chrono::nanoseconds >().count(), 1 ) )
+            , factor_( 1.0 )
+            , lastFrame_( chrono::steady_clock::now() )
+    {
+    }
+
+    void PowerLimit::limit( ChannelBuffer& values )
+    {
+        auto full = ChannelValue::maximum - ChannelValue::minimum;
+        auto factor = update( sumChannels( values ) / full * channelCurrent_ );
+        if ( factor >= 1.0 ) {
+            return;
+        }
+
+        std::transform( values.begin(), values.end(), values.begin(),
+                        [factor]( ChannelValue const& value ) { return ChannelValue( value.get() * factor ); } );
+    }
+
+    void PowerLimit::limit( uint8_t* dutyCycles, size_t size )
+    {
+        // the current is proportional to the duty cycle, so scaling the duty cycles scales the current alike
+        auto factor = update( sumDutyCycles( dutyCycles, size ) * channelCurrent_ );
+        if ( factor >= 1.0 ) {
+            return;
+        }
+
+        std::transform( dutyCycles, dutyCycles + size, dutyCycles,
+                        [factor]( uint8_t dutyCycle ) { return (uint8_t) ( dutyCycle * factor ); } );
+    }
+
+    double PowerLimit::update( double current )
+    {
+        auto now = chrono::steady_clock::now();
+        auto elapsed = chrono::duration_cast< chrono::nanoseconds >( now - lastFrame_ ).count();
+        lastFrame_ = now;
+
+        auto target = current > budget_ ? budget_ / current : 1.0;
+        factor_ = min( target, factor_ + elapsed * releasePerNs_ );
+
+        ++frames_;
+        peak_ = max( peak_, current );
+        if ( factor_ < 1.0 ) {
+            ++limited_;
+        }
+        return factor_;
+    }
+
+    void PowerLimit::statistics( ostream& os ) const
+    {
+        os << "{budget: " << budget_ << "mA, peak: " << peak_ << "mA, frames: " << frames_
+           << ", limited: " << limited_ << ", factor: " << factor_ << "}";
+    }
+
+} // namespace sc
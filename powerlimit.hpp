@@ -0,0 +1,49 @@
+#ifndef SCHLAZICONTROL_POWERLIMIT_HPP
+#define SCHLAZICONTROL_POWERLIMIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <iosfwd>
+
+#include "forward.hpp"
+
+namespace sc {
+
+    /**
+     * class PowerLimit
+     *
+     * Estimates the current drawn by a frame from the sum over all channels and scales the frame uniformly when
+     * the estimate exceeds the budget. The limit applies immediately and is released gradually over the release
+     * time so that brightness doesn't pump when a scene hovers around the budget.
+     *
+     * Channel values are taken as the duty cycle of the LEDs. Devices that correct the gamma limit the duty cycles
+     * they actually send instead, which draw far less current than the linear values at medium brightness.
+     */
+
+    class PowerLimit
+    {
+    public:
+        explicit PowerLimit( PropertyNode const& properties );
+
+        void limit( ChannelBuffer& values );
+        void limit( std::uint8_t* dutyCycles, std::size_t size );
+
+        void statistics( std::ostream& os ) const;
+
+    private:
+        double update( double current );
+
+        double budget_;
+        double channelCurrent_;
+        double releasePerNs_;
+        double factor_;
+        std::chrono::steady_clock::time_point lastFrame_;
+        double peak_ {};
+        std::size_t frames_ {};
+        std::size_t limited_ {};
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_POWERLIMIT_HPP
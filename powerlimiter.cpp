@@ -0,0 +1,34 @@
+#include <utility>
+
+#include "core/properties.hpp"
+#include "powerlimiter.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    static PropertyKey const inputProperty( "input" );
+
+    PowerLimiter::PowerLimiter( string&& id, Manager& manager, PropertyNode const& properties )
+            : Component( move( id ) )
+            , Output( manager, properties[ inputProperty ] )
+            , limit_( properties )
+    {
+    }
+
+    void PowerLimiter::set( Input const& input, ChannelBuffer const& values )
+    {
+        values_ = values;
+        limit_.limit( values_ );
+        inputChangeEvent_( values_ );
+    }
+
+    void PowerLimiter::doStatistics( ostream& os ) const
+    {
+        os << ", limit: " << makeStatistics( limit_ )
+           << "\n\t\tvalues: " << makeStatistics( values_ );
+    }
+
+    static ComponentRegistry< PowerLimiter > registry( "powerLimiter" );
+
+} // namespace sc
@@ -0,0 +1,44 @@
+#ifndef SCHLAZICONTROL_POWERLIMITER_HPP
+#define SCHLAZICONTROL_POWERLIMITER_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "core/input.hpp"
+#include "core/output.hpp"
+#include "powerlimit.hpp"
+#include "types.hpp"
+
+namespace sc {
+
+    class Manager;
+    class PropertyNode;
+
+    /**
+     * class PowerLimiter
+     */
+
+    class PowerLimiter final
+            : public Output
+            , public Input
+    {
+    public:
+        PowerLimiter( std::string&& id, Manager& manager, PropertyNode const& properties );
+
+        virtual bool acceptsChannels( std::size_t channels ) const override { return true; }
+        virtual std::size_t emitsChannels() const override { return inputs().front()->emitsChannels(); }
+        virtual std::size_t rank() const override { return inputRank(); }
+
+    protected:
+        virtual void set( Input const& input, ChannelBuffer const& values ) override;
+
+        virtual void doStatistics( std::ostream& os ) const override;
+
+    private:
+        PowerLimit limit_;
+        ChannelBuffer values_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_POWERLIMITER_HPP
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "core/timerwheel.hpp"
+
+using namespace std;
+using namespace sc;
+
+/**
+ * Regression tests for the timer wheel, exits with a non-zero status if one of them fails.
+ */
+
+using Clock = TimerWheel::Clock;
+
+static size_t failures;
+
+static void check( bool condition, char const* what, chrono::milliseconds timeout )
+{
+    if ( !condition ) {
+        cerr << "FAILED: " << what << " (timeout " << timeout.count() << "ms)\n";
+        ++failures;
+    }
+}
+
+/**
+ * A timer that starts itself again from its first expiry
+ */
+class RestartingTimer final
+        : public Expirable
+{
+public:
+    RestartingTimer( TimerWheel& wheel, chrono::milliseconds timeout )
+            : wheel_( wheel )
+            , timeout_( timeout )
+    {
+    }
+
+    vector< Clock::time_point > const& expiries() const { return expiries_; }
+
+protected:
+    void expire() override
+    {
+        expiries_.push_back( Clock::now() );
+        if ( expiries_.size() == 1 ) {
+            wheel_.start( *this, timeout_ );
+        }
+    }
+
+private:
+    TimerWheel& wheel_;
+    chrono::milliseconds timeout_;
+    vector< Clock::time_point > expiries_;
+};
+
+/**
+ * The wheel wakes up late, then the only timer is started again from its expiry. It must not catch up with the clock
+ * while the slot of the expiry is still being processed, otherwise a timeout of a little less than a revolution of
+ * the lowest level lands in that very slot and expires at once.
+ */
+static void testRestartAfterLateWakeup( chrono::milliseconds timeout )
+{
+    asio::io_context service;
+    TimerWheel wheel( service );
+    RestartingTimer timer( wheel, timeout );
+    wheel.start( timer, chrono::milliseconds( 10 ) );
+
+    // blocks the loop across the deadline, so that the wheel wakes up a few ticks late
+    asio::steady_timer blocker( service, chrono::milliseconds( 5 ) );
+    blocker.async_wait( []( asio::error_code ) { this_thread::sleep_for( chrono::milliseconds( 9 ) ); } );
+
+    service.run();
+
+    auto const& expiries = timer.expiries();
+    check( expiries.size() == 2, "restarted timer expires exactly twice", timeout );
+    if ( expiries.size() >= 2 ) {
+        check( expiries[ 1 ] - expiries[ 0 ] >= timeout, "restarted timer doesn't expire early", timeout );
+    }
+}
+
+/**
+ * A timer for several deadlines that is on the wheel only for the earliest one, like the timers of the triggers
+ */
+class BatchTimer final
+        : public Expirable
+{
+public:
+    BatchTimer( TimerWheel& wheel, vector< Clock::time_point > deadlines )
+            : wheel_( wheel )
+            , deadlines_( move( deadlines ) )
+            , expiries_()
+    {
+    }
+
+    void start()
+    {
+        wheel_.start( *this, deadlines_.front() - Clock::now() );
+    }
+
+    vector< Clock::time_point > const& deadlines() const { return deadlines_; }
+    vector< Clock::time_point > const& expiries() const { return expiries_; }
+
+protected:
+    void expire() override
+    {
+        auto now = Clock::now();
+        expiries_.push_back( now );
+        auto next = find_if( deadlines_.begin(), deadlines_.end(), [now]( auto deadline ) { return deadline > now; } );
+        if ( next != deadlines_.end() ) {
+            wheel_.start( *this, *next - now );
+        }
+    }
+
+private:
+    TimerWheel& wheel_;
+    vector< Clock::time_point > deadlines_;
+    vector< Clock::time_point > expiries_;
+};
+
+/**
+ * The same as above for a timer that starts itself again for its next deadline. Expiring it at once would make it
+ * expire over and over until the clock reaches the deadline.
+ */
+static void testBatchAfterLateWakeup( chrono::milliseconds distance )
+{
+    asio::io_context service;
+    TimerWheel wheel( service );
+    auto first = Clock::now() + chrono::milliseconds( 10 );
+    BatchTimer timer( wheel, { first, first + distance } );
+    timer.start();
+
+    asio::steady_timer blocker( service, chrono::milliseconds( 5 ) );
+    blocker.async_wait( []( asio::error_code ) { this_thread::sleep_for( chrono::milliseconds( 9 ) ); } );
+
+    service.run();
+
+    auto const& expiries = timer.expiries();
+    check( expiries.size() == 2, "batch timer expires once per deadline", distance );
+    if ( expiries.size() >= 2 ) {
+        check( expiries[ 1 ] >= timer.deadlines()[ 1 ], "batch timer doesn't expire early", distance );
+    }
+}
+
+int main()
+{
+    for ( auto timeout = 50 ; timeout <= 70 ; ++timeout ) {
+        testRestartAfterLateWakeup( chrono::milliseconds( timeout ) );
+        testBatchAfterLateWakeup( chrono::milliseconds( timeout ) );
+    }
+
+    if ( failures != 0 ) {
+        cerr << failures << " checks failed\n";
+        return 1;
+    }
+    cout << "all checks passed\n";
+    return 0;
+}
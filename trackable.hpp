@@ -1,6 +1,7 @@
 #ifndef SCHLAZICONTROL_TRACKABLE_HPP
 #define SCHLAZICONTROL_TRACKABLE_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <iosfwd>
 
@@ -10,6 +11,8 @@ namespace sc {
 
         /**
          * class TrackableTracker
+         *
+         * Shared by all instances of a type, which may be created on worker threads
          */
 
         class TrackableTracker
@@ -24,8 +27,8 @@ namespace sc {
             void statistics( std::ostream& os ) const;
 
         private:
-            std::size_t count_ {};
-            std::size_t allocated_ {};
+            std::atomic< std::size_t > count_ {};
+            std::atomic< std::size_t > allocated_ {};
         };
 
         /**
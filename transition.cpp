@@ -1,6 +1,7 @@
 #include <utility>
 
 #include "connection.hpp"
+#include "core/properties.hpp"
 #include "transition.hpp"
 
 using namespace std;
@@ -18,9 +19,20 @@ namespace sc {
      * class Transition
      */
 
+    static PropertyKey const updateIntervalProperty( "updateInterval", "auto" );
+
     Transition::Transition( string&& id )
             : Component( move( id ), false )
     {
     }
 
+    optional< chrono::nanoseconds > Transition::parseUpdateInterval( PropertyNode const& properties )
+    {
+        auto node = properties[ updateIntervalProperty ];
+        if ( node.is< string >() && node.as< string >() == "auto" ) {
+            return nullopt;
+        }
+        return node.as< chrono::nanoseconds >();
+    }
+
 } // namespace sc
\ No newline at end of file
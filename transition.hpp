@@ -1,15 +1,20 @@
 #ifndef SCHLAZICONTROL_TRANSITION_HPP
 #define SCHLAZICONTROL_TRANSITION_HPP
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <type_traits>
 
 #include "forward.hpp"
 #include "core/input.hpp"
 #include "core/output.hpp"
+#include "utility/optional.hpp"
 
 namespace sc {
 
+    class FusionKernel;
+
     /**
      * class TransitionInstance
      */
@@ -23,10 +28,28 @@ namespace sc {
 
         virtual Transition const& transition() const = 0;
 
+        /**
+         * A stateless instance is a pure function of its input, so its output may be reused while the input
+         * doesn't change
+         */
+        virtual bool stateless() const = 0;
+
         virtual bool acceptsChannels( std::size_t channels ) const = 0;
         virtual std::size_t emitsChannels( std::size_t channels ) const = 0;
 
         virtual void transform( Connection& connection, ChannelBuffer& values ) = 0;
+
+        /**
+         * Appends the transition to a kernel that fuses several stateless transitions into a single pass, returns
+         * false if the transition can't be fused
+         */
+        virtual bool fuse( std::size_t channels, FusionKernel& kernel ) const = 0;
+
+        /**
+         * Returns whether the instance may be transformed on a worker thread, provided that its input is the same
+         * as in the previous evaluation
+         */
+        virtual bool concurrent() const = 0;
     };
 
     /**
@@ -46,6 +69,8 @@ namespace sc {
 
         virtual Transition const& transition() const override { return transition_; }
 
+        virtual bool stateless() const override { return std::is_same< State, std::nullptr_t >::value; }
+
         virtual bool acceptsChannels( std::size_t channels ) const override { return transition_.acceptsChannels( channels ); }
         virtual std::size_t emitsChannels( std::size_t channels ) const override { return transition_.emitsChannels( channels ); }
 
@@ -54,6 +79,16 @@ namespace sc {
             transform( connection, values, state_ );
         }
 
+        virtual bool fuse( std::size_t channels, FusionKernel& kernel ) const override
+        {
+            return stateless() && transition_.fuse( channels, kernel );
+        }
+
+        virtual bool concurrent() const override
+        {
+            return concurrent( state_ );
+        }
+
     private:
         void transform( Connection& connection, ChannelBuffer& values, std::nullptr_t )
         {
@@ -66,6 +101,17 @@ namespace sc {
             transition_.transform( state, connection, values );
         }
 
+        bool concurrent( std::nullptr_t ) const
+        {
+            return transition_.concurrent();
+        }
+
+        template< typename Other >
+        bool concurrent( Other const& state ) const
+        {
+            return transition_.concurrent( state );
+        }
+
         Transition const& transition_;
         State state_;
     };
@@ -82,7 +128,23 @@ namespace sc {
 
         virtual std::unique_ptr< TransitionInstance > instantiate() const = 0;
 
+        bool fuse( std::size_t channels, FusionKernel& kernel ) const { return false; }
+
+        /**
+         * Transitions that only read themselves and their state in transform() hide these to allow it to run
+         * concurrently with other connections
+         */
+        bool concurrent() const { return false; }
+
+        template< typename State >
+        bool concurrent( State const& state ) const { return false; }
+
     protected:
+        /**
+         * Reads the optional "updateInterval" of a polling transition, which is empty if it is missing or "auto"
+         */
+        static optional< std::chrono::nanoseconds > parseUpdateInterval( PropertyNode const& properties );
+
         virtual void doStatistics( std::ostream& os ) const override {}
     };
 
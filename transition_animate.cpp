@@ -1,17 +1,84 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "connection.hpp"
 #include "event.hpp"
+#include "core/framegovernor.hpp"
+#include "core/logging.hpp"
 #include "core/manager.hpp"
+#include "core/properties.hpp"
+#include "core/workerpool.hpp"
 #include "transition_animate.hpp"
 #include "scoped.hpp"
 #include "types.hpp"
 #include "utility_colorwheel.hpp"
+#include "utility_math.hpp"
+#include "utility_string.hpp"
 
 using namespace std;
 
 namespace sc {
 
+    static Logger logger( "transition_animate" );
+
+    /**
+     * class AnimationFrameCache
+     */
+
+    class AnimationFrameCache
+    {
+    public:
+        AnimationFrameCache( size_t channels, size_t frames, double period )
+                : channels_( channels )
+                , frames_( frames )
+                , period_( period )
+                , values_( channels * frames )
+                , rendered_( frames )
+        {
+        }
+
+        size_t channels() const { return channels_; }
+
+        template< typename Render >
+        void play( ChannelBuffer& output, double time, Render&& render )
+        {
+            auto position = fmod( time, period_ ) / period_ * frames_;
+            auto index = min( (size_t) position, frames_ - 1 );
+            auto fraction = position - index;
+
+            auto a = frame( index, render );
+            auto b = frame( ( index + 1 ) % frames_, render );
+            for ( size_t k = 0 ; k < channels_ ; ++k ) {
+                output[ k ] = ChannelValue( ( a[ k ] + ( b[ k ] - a[ k ] ) * fraction ) * ChannelValue::maximum / 255.0 );
+            }
+        }
+
+    private:
+        template< typename Render >
+        uint8_t const* frame( size_t index, Render& render )
+        {
+            auto values = &values_[ index * channels_ ];
+            if ( !rendered_[ index ] ) {
+                ChannelBuffer buffer( channels_ );
+                render( buffer, index * period_ / frames_ );
+                for ( size_t k = 0 ; k < channels_ ; ++k ) {
+                    values[ k ] = RangedType< uint8_t >( buffer[ k ] ).get();
+                }
+                rendered_[ index ] = true;
+            }
+            return values;
+        }
+
+        size_t channels_;
+        size_t frames_;
+        double period_;
+        vector< uint8_t > values_;
+        vector< bool > rendered_;
+    };
+
     /**
      * class AnimateTransitionBase
      */
@@ -20,17 +87,97 @@ namespace sc {
     {
         bool polling {};
         double elapsed {};
+        double time {};
+        double keyTime {};
         ChannelBuffer output;
+        ChannelBuffer previous;
+        ChannelBuffer next;
+        ChannelBuffer coarse;
+        AnimationFrameCache* cache {};
         EventScope pollEventScope;
         std::shared_ptr< void > data;
     };
 
-    AnimateTransitionBase::AnimateTransitionBase( string&& id, Manager& manager )
+    static PropertyKey const detailProperty( "detail", 1 );
+    static PropertyKey const upsamplingProperty( "upsampling", "linear" );
+    static PropertyKey const renderIntervalProperty( "renderInterval" );
+    static PropertyKey const cacheBudgetProperty( "cacheBudget", 0 );
+
+    // samples per cycle of the pattern that keep the upsampled output indistinguishable from a full rendering
+    static constexpr double samplesPerCycle = 32.0;
+
+    static size_t parseDetail( PropertyNode const& node )
+    {
+        if ( node.is< string >() ) {
+            if ( node.as< string >() != "auto" ) {
+                throw runtime_error( str( "invalid detail \"", node.as< string >(), "\" in ", node.path() ) );
+            }
+            return 0;
+        }
+        return max< size_t >( node.as< size_t >(), 1 );
+    }
+
+    static bool parseUpsampling( PropertyNode const& node )
+    {
+        auto upsampling = node.as< string >();
+        if ( upsampling != "linear" && upsampling != "cubic" ) {
+            throw runtime_error( str( "invalid upsampling \"", upsampling, "\" in ", node.path() ) );
+        }
+        return upsampling == "cubic";
+    }
+
+    // computes the pixels [first, last) of the output
+    static void upsample( ChannelBuffer const& coarse, ChannelBuffer& output, bool cubic, size_t first, size_t last )
+    {
+        auto coarsePixels = coarse.size() / 3;
+        auto pixels = output.size() / 3;
+        auto ratio = (double) coarsePixels / pixels;
+        auto lastSample = coarsePixels - 1;
+        auto sample = [&coarse, lastSample]( size_t pixel, size_t channel ) {
+            return coarse[ min( pixel, lastSample ) * 3 + channel ].get();
+        };
+
+        for ( size_t i = first ; i < last ; ++i ) {
+            auto position = i * ratio;
+            auto j = (size_t) position;
+            auto f = position - j;
+            for ( size_t channel = 0 ; channel < 3 ; ++channel ) {
+                auto p1 = sample( j, channel );
+                auto p2 = sample( j + 1, channel );
+                double value;
+                if ( cubic ) {
+                    // catmull-rom spline through the neighbouring samples
+                    auto p0 = sample( j > 0 ? j - 1 : 0, channel );
+                    auto p3 = sample( j + 2, channel );
+                    value = p1 + 0.5 * f * ( p2 - p0 + f * ( 2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3
+                                                             + f * ( 3.0 * ( p1 - p2 ) + p3 - p0 ) ) );
+                    value = clip( value, ChannelValue::minimum, ChannelValue::maximum );
+                }
+                else {
+                    value = p1 + ( p2 - p1 ) * f;
+                }
+                output[ i * 3 + channel ] = ChannelValue( value );
+            }
+        }
+    }
+
+    AnimateTransitionBase::AnimateTransitionBase( string&& id, Manager& manager, PropertyNode const& properties )
             : Transition( move( id ) )
             , manager_( manager )
+            , detail_( parseDetail( properties[ detailProperty ] ) )
+            , cubic_( parseUpsampling( properties[ upsamplingProperty ] ) )
+            , renderInterval_( properties.has( renderIntervalProperty.name() )
+                               ? chrono::duration< double >(
+                                       properties[ renderIntervalProperty ].as< chrono::nanoseconds >() ).count()
+                               : 0.0 )
+            , cacheBudget_( properties[ cacheBudgetProperty ].as< size_t >() )
+            , updateInterval_( parseUpdateInterval( properties ) )
+            , cacheUsed_()
     {
     }
 
+    AnimateTransitionBase::~AnimateTransitionBase() = default;
+
     unique_ptr< TransitionInstance > AnimateTransitionBase::instantiate() const
     {
         return unique_ptr< TransitionInstance >( new TransitionInstanceImpl< AnimateTransitionBase, AnimateTransitionState >( *this ) );
@@ -43,9 +190,11 @@ namespace sc {
         }
         if ( state.output.empty() ) {
             state.output = ChannelBuffer( values.size() );
+            state.cache = frameCache( values.size() );
         }
 
-        Scoped scoped( [&state, &values] { values = state.output; state.polling = false; } );
+        // the animation clock catches up on frames that were dropped since the last transform
+        Scoped scoped( [&state, &values] { values = state.output; state.polling = false; state.elapsed = 0.0; } );
 
         if ( find_if( values.cbegin(), values.cend(), []( auto const& value ) { return value.on(); } ) == values.cend() ) {
             state.output.fill();
@@ -53,23 +202,141 @@ namespace sc {
             return;
         }
 
-        animate( state.output, state.data.get(), state.elapsed );
+        if ( state.polling ) {
+            state.time += state.elapsed;
+        }
+
+        if ( auto cache = state.cache ) {
+            cache->play( state.output, state.time, [this]( ChannelBuffer& output, double time ) {
+                ChannelBuffer coarse;
+                draw( output, coarse, 1, [this, time]( ChannelBuffer& buffer ) { render( buffer, time ); } );
+            } );
+        }
+        else if ( renderInterval_ > 0.0 ) {
+            interpolate( state );
+        }
+        else {
+            draw( state.output, state.coarse, manager_.governor().coarsening(),
+                  [this, &state]( ChannelBuffer& buffer ) { animate( buffer, state.data.get(), state.elapsed ); } );
+        }
 
         if ( !state.polling ) {
             Connection* safeConnection = &connection;
             AnimateTransitionState* safeState = &state;
-            state.pollEventScope = manager_.pollEvent().subscribe(
+            auto interval = updateInterval_ ? *updateInterval_ : connection.updateInterval();
+            state.pollEventScope = manager_.pollEvent( interval ).subscribe(
                     [this, safeConnection, safeState]( chrono::nanoseconds elapsed ) {
                         poll( *safeState, *safeConnection, elapsed );
                     } );
         }
     }
 
+    bool AnimateTransitionBase::concurrent( AnimateTransitionState const& state ) const
+    {
+        // a poll with an unchanged input neither subscribes nor unsubscribes, but the frame cache is shared
+        return state.polling && state.cache == nullptr;
+    }
+
     void AnimateTransitionBase::poll( AnimateTransitionState& state, Connection& connection, chrono::nanoseconds elapsed ) const
     {
         state.polling = true;
-        state.elapsed = chrono::duration< double >( elapsed ).count();
+        state.elapsed += chrono::duration< double >( elapsed ).count();
         connection.transfer();
     }
 
-} // namespace sc
\ No newline at end of file
+    void AnimateTransitionBase::interpolate( AnimateTransitionState& state ) const
+    {
+        // output lags one render interval behind, so there is always a keyframe ahead to interpolate towards
+        if ( state.next.empty() ) {
+            state.previous = ChannelBuffer( state.output.size() );
+            state.next = ChannelBuffer( state.output.size() );
+            draw( state.previous, state.coarse, manager_.governor().coarsening(),
+                  [this, &state]( ChannelBuffer& buffer ) { animate( buffer, state.data.get(), renderInterval_ ); } );
+            draw( state.next, state.coarse, manager_.governor().coarsening(),
+                  [this, &state]( ChannelBuffer& buffer ) { animate( buffer, state.data.get(), renderInterval_ ); } );
+        }
+        else if ( state.polling ) {
+            state.keyTime += state.elapsed;
+            while ( state.keyTime >= renderInterval_ ) {
+                state.keyTime -= renderInterval_;
+                swap( state.previous, state.next );
+                draw( state.next, state.coarse, manager_.governor().coarsening(),
+                      [this, &state]( ChannelBuffer& buffer ) { animate( buffer, state.data.get(), renderInterval_ ); } );
+            }
+        }
+
+        auto fraction = state.keyTime / renderInterval_;
+        state.output.begin(); // expands a compressed buffer before it is written concurrently
+        ChannelBuffer const& previous = state.previous;
+        ChannelBuffer const& next = state.next;
+        manager_.workers().parallelFor(
+                state.output.size(), WorkerPool::grain, [&, fraction]( size_t first, size_t last ) {
+                    for ( size_t k = first ; k < last ; ++k ) {
+                        auto a = previous[ k ].get();
+                        auto b = next[ k ].get();
+                        state.output[ k ] = ChannelValue( a + ( b - a ) * fraction );
+                    }
+                } );
+    }
+
+    size_t AnimateTransitionBase::detail( size_t pixels ) const
+    {
+        if ( detail_ != 0 ) {
+            return detail_;
+        }
+        auto frequency = spatialFrequency();
+        return frequency > 0.0 ? max< size_t >( (size_t) ( pixels / ( frequency * samplesPerCycle ) ), 1 ) : 1;
+    }
+
+    template< typename Render >
+    void AnimateTransitionBase::draw(
+            ChannelBuffer& output, ChannelBuffer& coarse, size_t coarsening, Render&& render ) const
+    {
+        auto pixels = output.size() / 3;
+        auto step = detail( pixels ) * coarsening;
+        auto coarsePixels = ( pixels + step - 1 ) / step;
+        if ( coarsePixels < 2 || coarsePixels == pixels ) {
+            render( output );
+            return;
+        }
+
+        if ( coarse.size() != coarsePixels * 3 ) {
+            coarse = ChannelBuffer( coarsePixels * 3 );
+        }
+        render( coarse );
+        output.begin(); // expands a compressed buffer before it is written concurrently
+        manager_.workers().parallelFor(
+                pixels, WorkerPool::grain / 3, [this, &coarse, &output]( size_t first, size_t last ) {
+                    upsample( coarse, output, cubic_, first, last );
+                } );
+    }
+
+    AnimationFrameCache* AnimateTransitionBase::frameCache( size_t channels ) const
+    {
+        // looked up by the first, never concurrent transform of an instance, so the map needs no lock
+        auto it = caches_.find( channels );
+        if ( it != caches_.end() ) {
+            return it->second.get();
+        }
+
+        auto& cache = caches_[ channels ];
+        auto period = cacheBudget_ > 0 ? this->period() : 0.0;
+        if ( period > 0.0 ) {
+            auto interval = chrono::duration< double >( manager_.updateInterval() ).count();
+            auto frames = max< size_t >( (size_t) ceil( period / interval ), 2 );
+            if ( cacheUsed_ + frames * channels <= cacheBudget_ ) {
+                logger.info( "caching ", frames, " frames of ", describe(), " for ", channels, " channels (",
+                             frames * channels, " bytes)" );
+                cacheUsed_ += frames * channels;
+                cache.reset( new AnimationFrameCache( channels, frames, period ) );
+            }
+            else {
+                logger.warning( "not caching ", describe(), " for ", channels, " channels: ", frames, " frames need ",
+                                frames * channels, " bytes, but only ", cacheBudget_ - cacheUsed_,
+                                " bytes of the budget are left" );
+            }
+        }
+        return cache.get();
+    }
+
+} // namespace sc
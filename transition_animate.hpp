@@ -3,6 +3,8 @@
 
 #include <cstddef>
 #include <chrono>
+#include <memory>
+#include <unordered_map>
 
 #include "forward.hpp"
 #include "transition.hpp"
@@ -10,9 +12,23 @@
 namespace sc {
 
     struct AnimateTransitionState;
+    class AnimationFrameCache;
 
     /**
      * class AnimateTransitionBase
+     *
+     * Periodic effects may be played back from a frame cache shared by all instances of the transition with the same
+     * number of channels. A cache holds one cycle of frames at the update interval and is filled lazily as frames are
+     * first needed, the caches of all channel counts share the cache budget.
+     *
+     * Otherwise effects may be rendered at a lower rate than the update interval, the frames in between are then
+     * interpolated from the last two rendered keyframes.
+     *
+     * Smooth effects may also be rendered at a fraction of the strip's resolution and upsampled to the full number
+     * of pixels, either with a fixed factor or with one derived from the effect's spatial frequency. The frame
+     * governor may coarsen the resolution further while frames exceed their budget, except for cached frames.
+     *
+     * Effects update at the rate of their connection unless they are given an update interval of their own.
      */
 
     class AnimateTransitionBase
@@ -25,16 +41,47 @@ namespace sc {
         std::size_t emitsChannels( std::size_t channels ) const { return channels; }
 
         void transform( AnimateTransitionState& state, Connection& connection, ChannelBuffer& values ) const;
+        bool concurrent( AnimateTransitionState const& state ) const;
         void poll( AnimateTransitionState& state, Connection& connection, std::chrono::nanoseconds elapsed ) const;
 
     protected:
-        AnimateTransitionBase( std::string&& id, Manager& manager );
+        AnimateTransitionBase( std::string&& id, Manager& manager, PropertyNode const& properties );
+        ~AnimateTransitionBase();
 
         virtual std::shared_ptr< void > instantiateData() const = 0;
         virtual void animate( ChannelBuffer& output, void* dataPtr, double elapsed ) const = 0;
 
+        /**
+         * Returns the time in seconds after which the effect repeats itself, or 0 if it isn't periodic
+         */
+        virtual double period() const { return 0.0; }
+
+        /**
+         * Renders the frame at the given time in seconds, must be implemented by effects that return a period
+         */
+        virtual void render( ChannelBuffer& output, double time ) const {}
+
+        /**
+         * Returns the number of cycles the effect's pattern runs through along the strip, or 0 if unknown
+         */
+        virtual double spatialFrequency() const { return 0.0; }
+
     private:
+        AnimationFrameCache* frameCache( std::size_t channels ) const;
+        void interpolate( AnimateTransitionState& state ) const;
+        std::size_t detail( std::size_t pixels ) const;
+
+        template< typename Render >
+        void draw( ChannelBuffer& output, ChannelBuffer& coarse, std::size_t coarsening, Render&& render ) const;
+
         Manager& manager_;
+        std::size_t detail_;
+        bool cubic_;
+        double renderInterval_;
+        std::size_t cacheBudget_;
+        optional< std::chrono::nanoseconds > updateInterval_;
+        mutable std::size_t cacheUsed_;
+        mutable std::unordered_map< std::size_t, std::unique_ptr< AnimationFrameCache > > caches_;
     };
 
     /**
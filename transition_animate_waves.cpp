@@ -1,3 +1,10 @@
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+
+#include <boost/integer/common_factor_rt.hpp>
+
 #include "core/properties.hpp"
 #include "transition_animate.hpp"
 #include "types.hpp"
@@ -21,6 +28,18 @@ namespace sc {
         }
     }
 
+    // finds a fraction with a small denominator that matches the value exactly enough to compute periods
+    static bool rationalize( double value, long& numerator, long& denominator )
+    {
+        for ( denominator = 1 ; denominator <= 1000 ; ++denominator ) {
+            numerator = lround( value * denominator );
+            if ( fabs( value - (double) numerator / denominator ) < 1e-9 ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     struct WaveAnimationData
     {
         double brightnessOffset {};
@@ -39,7 +58,7 @@ namespace sc {
     {
     public:
         TransitionAnimateWaves( std::string&& id, Manager& manager, PropertyNode const& properties )
-                : AnimateTransition< WaveAnimationData >( move( id ), manager )
+                : AnimateTransition< WaveAnimationData >( move( id ), manager, properties )
                 , colorRange_( properties[ colorRangeProperty ].as< double >() )
                 , colorSpeed_( properties[ colorSpeedProperty ].as< double >() )
                 , pulseRange_( properties[ pulseRangeProperty ].as< double >() )
@@ -52,23 +71,62 @@ namespace sc {
     protected:
         void animate( ChannelBuffer& output, WaveAnimationData& data, double elapsed ) const override
         {
-            ColorBuffer colorBuffer( output );
+            draw( output, data.brightnessOffset, data.colorOffset );
+
+            cyclicDecrement( data.brightnessOffset, pulseSpeed_ * elapsed );
+            cyclicIncrement( data.colorOffset, colorSpeed_ * elapsed );
+        }
+
+        double period() const override
+        {
+            // both waves repeat after 1 / speed, the effect repeats after the least common multiple of both
+            long numerator = 0;
+            long denominator = 1;
+            for ( auto speed : { fabs( pulseSpeed_ ), fabs( colorSpeed_ ) } ) {
+                long n, d;
+                if ( speed == 0.0 ) {
+                    continue;
+                }
+                if ( !rationalize( speed, n, d ) ) {
+                    return 0.0;
+                }
+                // the period of this wave is d / n, and lcm( a / b, c / d ) = lcm( a, c ) / gcd( b, d )
+                if ( numerator == 0 ) {
+                    numerator = d;
+                    denominator = n;
+                }
+                else {
+                    numerator = boost::integer::lcm( numerator, d );
+                    denominator = boost::integer::gcd( denominator, n );
+                }
+            }
+            return numerator != 0 ? (double) numerator / denominator : 0.0;
+        }
 
-            auto brightnessIndex = data.brightnessOffset;
-            auto colorIndex = data.colorOffset;
+        void render( ChannelBuffer& output, double time ) const override
+        {
+            auto brightnessOffset = -pulseSpeed_ * time;
+            auto colorOffset = colorSpeed_ * time;
+            draw( output, brightnessOffset - floor( brightnessOffset ), colorOffset - floor( colorOffset ) );
+        }
+
+        double spatialFrequency() const override
+        {
+            return std::max( fabs( colorRange_ ), fabs( pulseRange_ ) );
+        }
 
+    private:
+        void draw( ChannelBuffer& output, double brightnessIndex, double colorIndex ) const
+        {
+            ColorBuffer colorBuffer( output );
             for ( auto pixel : colorBuffer ) {
                 auto brightness = sin( brightnessIndex * 6.283 ) * ( maxBright_ - minBright_ ) + minBright_;
                 pixel = Colorwheel< 256 >::get( colorIndex * 255.0 ).scale( brightness );
                 cyclicIncrement( brightnessIndex, pulseRange_ / colorBuffer.size() );
                 cyclicIncrement( colorIndex, colorRange_ / colorBuffer.size() );
             }
-
-            cyclicDecrement( data.brightnessOffset, pulseSpeed_ * elapsed );
-            cyclicIncrement( data.colorOffset, colorSpeed_ * elapsed );
         }
 
-    private:
         double colorRange_;
         double colorSpeed_;
         double pulseRange_;
@@ -1,5 +1,6 @@
 #include <cstdint>
 
+#include "fusion.hpp"
 #include "transition_color.hpp"
 #include "types.hpp"
 
@@ -25,6 +26,12 @@ namespace sc {
         values = move( output );
     }
 
+    bool ColorTransition::fuse( size_t channels, FusionKernel& kernel ) const
+    {
+        vector< Rgb > colors;
+        return this->colors( channels, colors ) && kernel.colorize( colors );
+    }
+
 } // namespace sc
 
 
@@ -1,8 +1,12 @@
 #ifndef SCHLAZICONTROL_TRANSITION_COLOR_HPP
 #define SCHLAZICONTROL_TRANSITION_COLOR_HPP
 
+#include <cstddef>
+#include <vector>
+
 #include "forward.hpp"
 #include "transition.hpp"
+#include "utility_graphics.hpp"
 
 namespace sc {
 
@@ -16,11 +20,22 @@ namespace sc {
         std::size_t emitsChannels( std::size_t channels ) const { return channels * 3; }
 
         void transform( Connection& connection, ChannelBuffer& values ) const;
+        bool fuse( std::size_t channels, FusionKernel& kernel ) const;
+
+        /**
+         * Returns whether transform() only reads the transition, so that it may run on several threads at once
+         */
+        virtual bool concurrent() const { return true; }
 
     protected:
         explicit ColorTransition( std::string&& id );
 
         virtual void transform( ChannelBuffer const& values, ColorBuffer& output ) const = 0;
+
+        /**
+         * Provides the colour of every channel if it doesn't depend on the value, so the transition can be fused
+         */
+        virtual bool colors( std::size_t channels, std::vector< Rgb >& colors ) const { return false; }
     };
 
 } // namespace sc
@@ -28,6 +28,12 @@ namespace sc {
             } );
         }
 
+        bool colors( size_t channels, vector< Rgb >& colors ) const override
+        {
+            colors.assign( channels, color_ );
+            return true;
+        }
+
     private:
         Rgb color_;
     };
@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "core/properties.hpp"
 #include "transition_color.hpp"
@@ -29,21 +33,44 @@ namespace sc {
     protected:
         void transform( ChannelBuffer const& values, ColorBuffer& output ) const override
         {
-            auto steps = values.size() - 1;
-            auto dr = ( (double) end_.red() - start_.red() ) / steps;
-            auto dg = ( (double) end_.green() - start_.green() ) / steps;
-            auto db = ( (double) end_.blue() - start_.blue() ) / steps;
+            auto const& colors = gradient( values.size() );
             for ( size_t i = 0 ; i < values.size() ; ++i ) {
-                output[ i ] = Rgb( (uint8_t) ( start_.red() + dr * i ),
-                                   (uint8_t) ( start_.green() + dg * i ),
-                                   (uint8_t) ( start_.blue() + db * i )
-                                 ).scale( RangedUnit< double >( values[ i ] ).get() );
+                output[ i ] = Rgb( colors[ i ] ).scale( RangedUnit< double >( values[ i ] ).get() );
             }
         }
 
+        bool colors( size_t channels, vector< Rgb >& colors ) const override
+        {
+            colors = gradient( channels );
+            return true;
+        }
+
     private:
+        // the interpolated colors only depend on the size, so they are computed once per size and kept for all
+        // connections, the elements of the map stay where they are when others are added
+        vector< Rgb > const& gradient( size_t size ) const
+        {
+            lock_guard< mutex > lock( mutex_ );
+            auto& colors = gradients_[ size ];
+            if ( colors.size() != size ) {
+                auto steps = max< size_t >( size, 2 ) - 1;
+                auto dr = ( (double) end_.red() - start_.red() ) / steps;
+                auto dg = ( (double) end_.green() - start_.green() ) / steps;
+                auto db = ( (double) end_.blue() - start_.blue() ) / steps;
+                colors.reserve( size );
+                for ( size_t i = 0 ; i < size ; ++i ) {
+                    colors.emplace_back( (uint8_t) ( start_.red() + dr * i ),
+                                         (uint8_t) ( start_.green() + dg * i ),
+                                         (uint8_t) ( start_.blue() + db * i ) );
+                }
+            }
+            return colors;
+        }
+
         Rgb start_;
         Rgb end_;
+        mutable mutex mutex_;
+        mutable unordered_map< size_t, vector< Rgb > > gradients_;
     };
 
     static TransitionRegistry< GradientColorTransition > registry( "color:gradient" );
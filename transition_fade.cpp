@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 #include "connection.hpp"
@@ -6,10 +9,10 @@
 #include "core/manager.hpp"
 #include "core/properties.hpp"
 #include "scoped.hpp"
-#include "timer.hpp"
 #include "transition_fade.hpp"
 #include "types.hpp"
-#include "utility/algorithm.hpp"
+#include "utility_easing.hpp"
+#include "utility_string.hpp"
 
 using namespace std;
 
@@ -21,25 +24,79 @@ namespace sc {
 
     struct FadeTransitionState
     {
+        struct Fade
+        {
+            size_t channel;
+            double from;
+            double to;
+            double progress;
+            double rate;
+        };
+
+        static constexpr size_t idle = numeric_limits< size_t >::max();
+
         bool polling;
+        bool subscribed;
+        size_t generation;
+        double elapsed;
         ChannelBuffer output;
-        ChannelBuffer target;
-        vector< int > deltas;
-        double factor;
+        vector< Fade > fades;
+        vector< size_t > slots;
         EventScope pollEventScope;
     };
 
+    constexpr size_t FadeTransitionState::idle;
+
     /**
      * class FadeTransition
      */
 
     static PropertyKey const speedProperty( "speed" );
+    static PropertyKey const durationProperty( "duration" );
+    static PropertyKey const easingProperty( "easing", "linear" );
+
+    // brightness steps of the outputs, a fade doesn't need to update more often than it moves by one of them
+    static constexpr double outputLevels = 256.0;
+
+    static double linearEasing( double progress )
+    {
+        return progress;
+    }
+
+    static FadeTransition::Easing easingFunction( string const& name )
+    {
+        if ( name == "linear" ) {
+            return &linearEasing;
+        }
+        if ( name == "easeIn" ) {
+            return &EasingTable< detail::EaseInCurve >::get;
+        }
+        if ( name == "easeOut" ) {
+            return &EasingTable< detail::EaseOutCurve >::get;
+        }
+        if ( name == "easeInOut" ) {
+            return &EasingTable< detail::EaseInOutCurve >::get;
+        }
+        if ( name == "exponential" ) {
+            return &EasingTable< detail::ExponentialCurve >::get;
+        }
+        throw runtime_error( str( "unknown easing \"", name, "\"" ) );
+    }
 
     FadeTransition::FadeTransition( string&& id, Manager& manager, PropertyNode const& properties )
             : Transition( move( id ) )
             , manager_( manager )
-            , deltaPerNs_( ( ChannelValue::maximum - ChannelValue::minimum ) /
-                                   properties[ speedProperty ].as< chrono::nanoseconds >().count() )
+            , deltaPerNs_( properties.has( durationProperty.name() ) ? 0.0
+                           : ( ChannelValue::maximum - ChannelValue::minimum ) /
+                             properties[ speedProperty ].as< chrono::nanoseconds >().count() )
+            , progressPerNs_( properties.has( durationProperty.name() )
+                              ? 1.0 / properties[ durationProperty ].as< chrono::nanoseconds >().count() : 0.0 )
+            , easing_( easingFunction( properties[ easingProperty ].as< string >() ) )
+            , updateInterval_( parseUpdateInterval( properties ) )
+            , autoInterval_( chrono::nanoseconds( (chrono::nanoseconds::rep)
+                    ( 1.0 / ( progressPerNs_ != 0.0
+                              ? progressPerNs_
+                              : deltaPerNs_ / ( ChannelValue::maximum - ChannelValue::minimum ) ) / outputLevels ) ) )
     {
     }
 
@@ -50,73 +107,101 @@ namespace sc {
 
     void FadeTransition::transform( FadeTransitionState& state, Connection& connection, ChannelBuffer& values ) const
     {
-        if ( state.output.empty() ) {
+        if ( state.output.size() != values.size() ) {
             state.output = ChannelBuffer( values.size() );
-            state.deltas.resize( values.size() );
+            state.fades.clear();
+            state.slots.assign( values.size(), FadeTransitionState::idle );
         }
 
-        Scoped scoped( [&state, &values] { values = state.output; state.polling = false; } );
-        state.target = move( values );
+        // the fades advance by the time of every poll since the last transform, dropped frames included
+        Scoped scoped( [&state, &values] { values = state.output; state.polling = false; state.elapsed = 0.0; } );
 
-        bool changed = false;
-        if ( !state.polling ) {
-            changed = calculateDeltas( state );
+        if ( state.polling ) {
+            advance( state );
         }
-
-        if ( calculateOutput( state ) ) {
-            changed = true;
+        // a poll and an input change may be handled by the same evaluation
+        if ( !state.polling || state.generation != connection.generation() ) {
+            state.generation = connection.generation();
+            auto it = values.cbegin();
+            for ( size_t channel = 0 ; channel < values.size() ; ++channel, ++it ) {
+                auto slot = state.slots[ channel ];
+                auto target = slot != FadeTransitionState::idle ? state.fades[ slot ].to : state.output[ channel ].get();
+                if ( it->get() != target ) {
+                    start( state, channel, it->get() );
+                }
+            }
         }
 
-        if ( !changed ) {
+        if ( state.fades.empty() ) {
             state.pollEventScope = nullptr;
+            state.subscribed = false;
             return;
         }
 
-        if ( !state.polling ) {
+        if ( !state.subscribed ) {
             Connection* safeConnection = &connection;
             FadeTransitionState* safeState = &state;
-            state.pollEventScope = manager_.pollEvent().subscribe(
+            auto interval = updateInterval_ ? *updateInterval_ : max( connection.updateInterval(), autoInterval_ );
+            state.pollEventScope = manager_.pollEvent( interval ).subscribe(
                     [this, safeConnection, safeState]( chrono::nanoseconds elapsed ) {
-                        poll( *safeState, *safeConnection, (double) elapsed.count() * deltaPerNs_ );
+                        poll( *safeState, *safeConnection, elapsed );
                     } );
+            state.subscribed = true;
         }
     }
 
-    void FadeTransition::poll( FadeTransitionState& state, Connection& connection, double factor ) const
+    void FadeTransition::poll( FadeTransitionState& state, Connection& connection, chrono::nanoseconds elapsed ) const
     {
         state.polling = true;
-        state.factor = factor;
+        state.elapsed += (double) elapsed.count();
         connection.transfer();
     }
 
-    bool FadeTransition::calculateDeltas( FadeTransitionState& state ) const
+    void FadeTransition::start( FadeTransitionState& state, size_t channel, double target ) const
     {
-        auto changed = false;
-        std::transform( state.target.begin(), state.target.end(), state.output.begin(), state.deltas.begin(),
-                        [&changed]( ChannelValue const& target, ChannelValue const& output ) {
-                            auto delta = target.get() - output.get();
-                            if ( delta == 0.0 ) {
-                                return 0;
-                            }
-                            changed = true;
-                            return signbit( delta ) ? -1 : 1;
-                        } );
-        return changed;
+        auto& slot = state.slots[ channel ];
+        auto from = state.output[ channel ].get();
+        if ( from == target ) {
+            // the channel was retargeted to where it currently is, so the running fade is obsolete
+            if ( slot != FadeTransitionState::idle ) {
+                auto& fade = state.fades[ slot ];
+                fade.to = from;
+                fade.progress = 1.0;
+            }
+            return;
+        }
+
+        auto rate = progressPerNs_ != 0.0 ? progressPerNs_ : deltaPerNs_ / fabs( target - from );
+        if ( slot == FadeTransitionState::idle ) {
+            slot = state.fades.size();
+            state.fades.push_back( { channel, from, target, 0.0, rate } );
+        }
+        else {
+            state.fades[ slot ] = { channel, from, target, 0.0, rate };
+        }
     }
 
-    bool FadeTransition::calculateOutput( FadeTransitionState& state ) const
+    void FadeTransition::advance( FadeTransitionState& state ) const
     {
-        auto changed = false;
-        auto factor = state.factor;
-        sc::transform( [&changed, factor]( auto const& output, auto const& delta, auto const& target ) {
-                           double result = output.get() + factor * delta;
-                           result = ( delta > 0.0 && result > target.get() ) || ( delta < 0.0 && result < target.get() )
-                                    ? target.get() : result;
-                           changed = changed || result != output.get();
-                           return ChannelValue( result );
-                       }, state.output.begin(), state.output.end(), state.output.begin(), state.deltas.begin(),
-                       state.target.begin() );
-        return changed;
+        auto& fades = state.fades;
+        for ( size_t i = 0 ; i < fades.size() ; ) {
+            auto& fade = fades[ i ];
+            fade.progress += fade.rate * state.elapsed;
+            if ( fade.progress < 1.0 ) {
+                state.output[ fade.channel ] = ChannelValue( fade.from + ( fade.to - fade.from ) * easing_( fade.progress ) );
+                ++i;
+                continue;
+            }
+
+            // finished, move the last fade into this slot
+            state.output[ fade.channel ] = ChannelValue( fade.to );
+            state.slots[ fade.channel ] = FadeTransitionState::idle;
+            if ( i != fades.size() - 1 ) {
+                fade = fades.back();
+                state.slots[ fade.channel ] = i;
+            }
+            fades.pop_back();
+        }
     }
 
     static TransitionRegistry< FadeTransition > registry( "fade" );
@@ -14,12 +14,20 @@ namespace sc {
 
     /**
      * class FadeTransition
+     *
+     * Fades every channel towards its target either at a constant speed or within a fixed duration, optionally
+     * following an easing curve. Only the channels still in flight are kept in the state, so the cost of a frame
+     * scales with the number of fading channels rather than the size of the buffer.
+     *
+     * Slow fades are updated at a lower rate, about once per brightness step, unless an update interval is given.
      */
 
     class FadeTransition final
             : public Transition
     {
     public:
+        using Easing = double (*)( double progress );
+
         FadeTransition( std::string&& id, Manager& manager, PropertyNode const& properties );
 
         virtual std::unique_ptr< TransitionInstance > instantiate() const override;
@@ -28,14 +36,18 @@ namespace sc {
         std::size_t emitsChannels( std::size_t channels ) const { return channels; }
 
         void transform( FadeTransitionState& state, Connection& connection, ChannelBuffer& values ) const;
-        void poll( FadeTransitionState& state, Connection& connection, double factor ) const;
+        void poll( FadeTransitionState& state, Connection& connection, std::chrono::nanoseconds elapsed ) const;
 
     private:
-        bool calculateDeltas( FadeTransitionState& state ) const;
-        bool calculateOutput( FadeTransitionState& state ) const;
+        void start( FadeTransitionState& state, std::size_t channel, double target ) const;
+        void advance( FadeTransitionState& state ) const;
 
         Manager& manager_;
         double deltaPerNs_;
+        double progressPerNs_;
+        Easing easing_;
+        optional< std::chrono::nanoseconds > updateInterval_;
+        std::chrono::nanoseconds autoInterval_;
     };
 
 } // namespace sc
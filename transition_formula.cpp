@@ -0,0 +1,137 @@
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "connection.hpp"
+#include "event.hpp"
+#include "expression.hpp"
+#include "core/manager.hpp"
+#include "core/properties.hpp"
+#include "scoped.hpp"
+#include "transition_formula.hpp"
+#include "types.hpp"
+#include "utility_math.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * struct FormulaTransitionState
+     */
+
+    struct FormulaTransitionState
+    {
+        bool polling {};
+        double time {};
+        vector< double > inputs;
+        vector< double > results;
+        vector< double > scratch;
+        EventScope pollEventScope;
+    };
+
+    /**
+     * class FormulaTransition
+     */
+
+    static PropertyKey const formulaProperty( "formula" );
+    static PropertyKey const paletteProperty( "palette" );
+
+    static vector< Rgb > parsePalette( PropertyNode const& properties )
+    {
+        return properties.has( paletteProperty.name() )
+                ? properties[ paletteProperty ].as< vector< Rgb > >()
+                : vector< Rgb >();
+    }
+
+    FormulaTransition::FormulaTransition( string&& id, Manager& manager, PropertyNode const& properties )
+            : Transition( move( id ) )
+            , manager_( manager )
+            , formula_( expression::parseFormula( properties[ formulaProperty ].as< string >() ) )
+            , palette_( parsePalette( properties ) )
+    {
+    }
+
+    unique_ptr< TransitionInstance > FormulaTransition::instantiate() const
+    {
+        return unique_ptr< TransitionInstance >(
+                new TransitionInstanceImpl< FormulaTransition, FormulaTransitionState >( *this ) );
+    }
+
+    void FormulaTransition::transform( FormulaTransitionState& state, Connection& connection, ChannelBuffer& values ) const
+    {
+        if ( state.scratch.empty() ) {
+            formula_.prepare( state.scratch );
+        }
+
+        Scoped scoped( [&state] { state.polling = false; } );
+
+        auto size = values.size();
+        ChannelBuffer output( emitsChannels( size ) );
+
+        if ( find_if( values.cbegin(), values.cend(), []( auto const& value ) { return value.on(); } ) == values.cend() ) {
+            values = move( output );
+            state.time = 0.0;
+            state.pollEventScope = nullptr;
+            return;
+        }
+
+        state.inputs.resize( size );
+        state.results.resize( size );
+        std::transform( values.cbegin(), values.cend(), state.inputs.begin(),
+                        []( auto const& value ) { return RangedUnit< double >( value ).get(); } );
+
+        for ( size_t first = 0 ; first < size ; first += Formula::blockSize ) {
+            formula_.evaluate( state.scratch, state.inputs.data(), first, min( Formula::blockSize, size - first ),
+                               size, state.time, &state.results[ first ] );
+        }
+
+        if ( palette_.empty() ) {
+            std::transform( state.results.cbegin(), state.results.cend(), output.begin(),
+                            []( double result ) { return ChannelValue( rangedUnit( clip( result, 0.0, 1.0 ) ) ); } );
+        }
+        else {
+            ColorBuffer colorBuffer( output );
+            for ( size_t i = 0 ; i < size ; ++i ) {
+                colorBuffer[ i ] = lookup( state.results[ i ] ).scale( state.inputs[ i ] );
+            }
+        }
+        values = move( output );
+
+        if ( formula_.uses( Formula::time ) && !state.polling ) {
+            Connection* safeConnection = &connection;
+            FormulaTransitionState* safeState = &state;
+            state.pollEventScope = manager_.pollEvent( connection.updateInterval() ).subscribe(
+                    [this, safeConnection, safeState]( chrono::nanoseconds elapsed ) {
+                        poll( *safeState, *safeConnection, elapsed );
+                    } );
+        }
+    }
+
+    bool FormulaTransition::concurrent( FormulaTransitionState const& state ) const
+    {
+        // a poll with an unchanged input doesn't touch the subscription
+        return state.polling;
+    }
+
+    void FormulaTransition::poll( FormulaTransitionState& state, Connection& connection, chrono::nanoseconds elapsed ) const
+    {
+        state.polling = true;
+        state.time += chrono::duration< double >( elapsed ).count();
+        connection.transfer();
+    }
+
+    Rgb FormulaTransition::lookup( double position ) const
+    {
+        auto scaled = ( position - floor( position ) ) * palette_.size();
+        auto index = min( (size_t) scaled, palette_.size() - 1 );
+        auto fraction = scaled - index;
+        auto const& from = palette_[ index ];
+        auto const& to = palette_[ ( index + 1 ) % palette_.size() ];
+        auto blend = [fraction]( uint8_t a, uint8_t b ) { return (uint8_t) ( a + ( b - a ) * fraction ); };
+        return Rgb( blend( from.red(), to.red() ), blend( from.green(), to.green() ), blend( from.blue(), to.blue() ) );
+    }
+
+    static TransitionRegistry< FormulaTransition > registry( "formula" );
+
+} // namespace sc
@@ -0,0 +1,52 @@
+#ifndef SCHLAZICONTROL_TRANSITION_FORMULA_HPP
+#define SCHLAZICONTROL_TRANSITION_FORMULA_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "formula.hpp"
+#include "forward.hpp"
+#include "transition.hpp"
+#include "utility_graphics.hpp"
+
+namespace sc {
+
+    struct FormulaTransitionState;
+
+    /**
+     * class FormulaTransition
+     *
+     * Computes every channel from a formula over the channel index (i), the channel count (n), the running time in
+     * seconds (t) and the input value (v, 0..1). Without a palette the result is the channel brightness (0..1),
+     * with a palette it selects a colour that is scaled by the input value. Like the animations, the output is off
+     * while no input channel is on.
+     */
+
+    class FormulaTransition final
+            : public Transition
+    {
+    public:
+        FormulaTransition( std::string&& id, Manager& manager, PropertyNode const& properties );
+
+        virtual std::unique_ptr< TransitionInstance > instantiate() const override;
+
+        bool acceptsChannels( std::size_t channels ) const { return true; }
+        std::size_t emitsChannels( std::size_t channels ) const { return palette_.empty() ? channels : channels * 3; }
+
+        void transform( FormulaTransitionState& state, Connection& connection, ChannelBuffer& values ) const;
+        bool concurrent( FormulaTransitionState const& state ) const;
+        void poll( FormulaTransitionState& state, Connection& connection, std::chrono::nanoseconds elapsed ) const;
+
+    private:
+        Rgb lookup( double position ) const;
+
+        Manager& manager_;
+        Formula formula_;
+        std::vector< Rgb > palette_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_TRANSITION_FORMULA_HPP
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "connection.hpp"
+#include "event.hpp"
+#include "core/manager.hpp"
+#include "core/properties.hpp"
+#include "scoped.hpp"
+#include "transition_history.hpp"
+#include "types.hpp"
+#include "utility_string.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * struct HistoryTransitionState
+     */
+
+    struct HistoryTransitionState
+    {
+        bool polling {};
+        bool subscribed {};
+        size_t channels {};
+        size_t head {};
+        size_t steady {};
+        vector< float > arena;
+        vector< float const* > sources;
+        EventScope pollEventScope;
+    };
+
+    /**
+     * class HistoryTransition
+     */
+
+    static PropertyKey const decayProperty( "decay" );
+    static PropertyKey const tapsProperty( "taps" );
+    static PropertyKey const delayProperty( "delay" );
+    static PropertyKey const gainProperty( "gain" );
+    static PropertyKey const blendProperty( "blend", "max" );
+
+    static vector< HistoryTransition::Tap > parseTaps( PropertyNode const& properties )
+    {
+        vector< HistoryTransition::Tap > taps;
+        if ( properties.has( decayProperty.name() ) ) {
+            taps.push_back( { 1, properties[ decayProperty ].as< float >() } );
+        }
+        if ( properties.has( tapsProperty.name() ) ) {
+            for ( auto const& tap : properties[ tapsProperty ] ) {
+                taps.push_back( { tap[ delayProperty ].as< size_t >(), tap[ gainProperty ].as< float >() } );
+            }
+        }
+        if ( taps.empty() ) {
+            throw runtime_error( str( "history transition in ", properties.path(), " needs a decay or taps" ) );
+        }
+        for ( auto const& tap : taps ) {
+            if ( tap.delay == 0 ) {
+                throw runtime_error( str( "invalid tap in ", properties.path(), ": delay must be at least 1" ) );
+            }
+        }
+        return taps;
+    }
+
+    static bool parseBlend( PropertyNode const& node )
+    {
+        auto blend = node.as< string >();
+        if ( blend != "max" && blend != "add" ) {
+            throw runtime_error( str( "invalid blend \"", blend, "\" in ", node.path() ) );
+        }
+        return blend == "add";
+    }
+
+    HistoryTransition::HistoryTransition( string&& id, Manager& manager, PropertyNode const& properties )
+            : Transition( move( id ) )
+            , manager_( manager )
+            , taps_( parseTaps( properties ) )
+            , length_( max_element( taps_.cbegin(), taps_.cend(),
+                                    []( Tap const& a, Tap const& b ) { return a.delay < b.delay; } )->delay )
+            , add_( parseBlend( properties[ blendProperty ] ) )
+    {
+    }
+
+    unique_ptr< TransitionInstance > HistoryTransition::instantiate() const
+    {
+        return unique_ptr< TransitionInstance >(
+                new TransitionInstanceImpl< HistoryTransition, HistoryTransitionState >( *this ) );
+    }
+
+    void HistoryTransition::transform( HistoryTransitionState& state, Connection& connection, ChannelBuffer& values ) const
+    {
+        static constexpr float epsilon = ChannelValue::epsilon;
+        static constexpr float full = ChannelValue::maximum;
+
+        auto channels = values.size();
+        if ( state.channels != channels ) {
+            // the one and only allocation, the ring holds length_ frames of the connection's channel count
+            state.channels = channels;
+            state.head = 0;
+            state.arena.assign( length_ * channels, 0.0f );
+            state.sources.resize( taps_.size() );
+        }
+
+        Scoped scoped( [&state] { state.polling = false; } );
+
+        // on a poll the ring advances by one frame and the new output is stored at the head, otherwise the current
+        // output is only recomputed against the same history
+        auto head = state.polling ? ( state.head + 1 ) % length_ : state.head;
+        for ( size_t i = 0 ; i < taps_.size() ; ++i ) {
+            auto frame = ( head + length_ - taps_[ i ].delay ) % length_;
+            state.sources[ i ] = &state.arena[ frame * channels ];
+        }
+        auto target = state.polling ? &state.arena[ head * channels ] : nullptr;
+        auto last = &state.arena[ state.head * channels ];
+        state.head = head;
+
+        auto sources = state.sources.data();
+        auto tapCount = taps_.size();
+        auto changed = false;
+        for ( size_t k = 0 ; k < channels ; ++k ) {
+            auto value = (float) values[ k ].get();
+            for ( size_t i = 0 ; i < tapCount ; ++i ) {
+                auto echo = sources[ i ][ k ] * taps_[ i ].gain;
+                value = add_ ? value + echo : max( value, echo );
+            }
+            value = value < epsilon ? 0.0f : min( value, full );
+            changed = changed || value != last[ k ];
+            if ( target ) {
+                target[ k ] = value;
+            }
+            values[ k ] = ChannelValue( (double) value );
+        }
+
+        // keep running until the whole ring holds the same frame, then the output can't change without the input,
+        // whether the trail has faded out or the input is steady
+        if ( changed ) {
+            state.steady = 0;
+        }
+        else if ( target ) {
+            ++state.steady;
+        }
+        if ( state.steady >= length_ ) {
+            state.pollEventScope = nullptr;
+            state.subscribed = false;
+            return;
+        }
+
+        if ( !state.subscribed ) {
+            Connection* safeConnection = &connection;
+            HistoryTransitionState* safeState = &state;
+            state.pollEventScope = manager_.pollEvent( connection.updateInterval() ).subscribe(
+                    [this, safeConnection, safeState]( chrono::nanoseconds ) {
+                        poll( *safeState, *safeConnection );
+                    } );
+            state.subscribed = true;
+        }
+    }
+
+    void HistoryTransition::poll( HistoryTransitionState& state, Connection& connection ) const
+    {
+        state.polling = true;
+        connection.transfer();
+    }
+
+    static TransitionRegistry< HistoryTransition > registry( "history" );
+
+} // namespace sc
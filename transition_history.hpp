@@ -0,0 +1,54 @@
+#ifndef SCHLAZICONTROL_TRANSITION_HISTORY_HPP
+#define SCHLAZICONTROL_TRANSITION_HISTORY_HPP
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "forward.hpp"
+#include "transition.hpp"
+
+namespace sc {
+
+    struct HistoryTransitionState;
+
+    /**
+     * class HistoryTransition
+     *
+     * Combines the current frame with earlier output frames to build trails and echoes. Every tap reads the output
+     * from a number of frames ago, weighted by its gain; "decay" is a shorthand for a tap one frame back. The past
+     * frames are kept in a ring inside a single arena that is allocated once, and the history advances by one frame
+     * per update interval.
+     */
+
+    class HistoryTransition final
+            : public Transition
+    {
+    public:
+        struct Tap
+        {
+            std::size_t delay;
+            float gain;
+        };
+
+        HistoryTransition( std::string&& id, Manager& manager, PropertyNode const& properties );
+
+        virtual std::unique_ptr< TransitionInstance > instantiate() const override;
+
+        bool acceptsChannels( std::size_t channels ) const { return true; }
+        std::size_t emitsChannels( std::size_t channels ) const { return channels; }
+
+        void transform( HistoryTransitionState& state, Connection& connection, ChannelBuffer& values ) const;
+        void poll( HistoryTransitionState& state, Connection& connection ) const;
+
+    private:
+        Manager& manager_;
+        std::vector< Tap > taps_;
+        std::size_t length_;
+        bool add_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_TRANSITION_HISTORY_HPP
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "core/properties.hpp"
+#include "fusion.hpp"
+#include "transition_map.hpp"
+#include "types.hpp"
+
+using namespace std;
+
+namespace sc {
+
+    /**
+     * class MapTransition
+     */
+
+    constexpr size_t MapTransition::unmapped;
+
+    static PropertyKey const channelsPerPixelProperty( "channelsPerPixel", 3 );
+    static PropertyKey const widthProperty( "width" );
+    static PropertyKey const heightProperty( "height", 1 );
+    static PropertyKey const serpentineProperty( "serpentine", false );
+    static PropertyKey const reverseProperty( "reverse", false );
+    static PropertyKey const indicesProperty( "indices" );
+
+    static vector< long > makeGridLayout( PropertyNode const& properties )
+    {
+        auto width = properties[ widthProperty ].as< size_t >();
+        auto height = properties[ heightProperty ].as< size_t >();
+        auto serpentine = properties[ serpentineProperty ].as< bool >();
+
+        vector< long > layout( width * height );
+        for ( size_t row = 0 ; row < height ; ++row ) {
+            for ( size_t column = 0 ; column < width ; ++column ) {
+                auto logical = serpentine && row % 2 == 1 ? width - 1 - column : column;
+                layout[ row * width + column ] = row * width + logical;
+            }
+        }
+        return layout;
+    }
+
+    static vector< long > makeLayout( PropertyNode const& properties )
+    {
+        auto layout = properties.has( indicesProperty.name() )
+                ? properties[ indicesProperty ].as< vector< long > >()
+                : makeGridLayout( properties );
+        if ( properties[ reverseProperty ].as< bool >() ) {
+            reverse( layout.begin(), layout.end() );
+        }
+        return layout;
+    }
+
+    static vector< size_t > compileLayout( vector< long > const& layout, size_t channelsPerPixel )
+    {
+        vector< size_t > table;
+        table.reserve( layout.size() * channelsPerPixel );
+        for ( auto pixel : layout ) {
+            for ( size_t channel = 0 ; channel < channelsPerPixel ; ++channel ) {
+                table.push_back( pixel >= 0 ? pixel * channelsPerPixel + channel : MapTransition::unmapped );
+            }
+        }
+        return table;
+    }
+
+    static size_t requiredChannels( vector< size_t > const& table )
+    {
+        size_t result = 0;
+        for ( auto source : table ) {
+            if ( source != MapTransition::unmapped ) {
+                result = max( result, source + 1 );
+            }
+        }
+        return result;
+    }
+
+    MapTransition::MapTransition( string&& id, Manager& manager, PropertyNode const& properties )
+            : Transition( move( id ) )
+            , table_( compileLayout( makeLayout( properties ),
+                                     properties[ channelsPerPixelProperty ].as< size_t >() ) )
+            , requiredChannels_( requiredChannels( table_ ) )
+    {
+        if ( table_.empty() ) {
+            throw runtime_error( str( "invalid layout in component ", describe(), ": layout is empty" ) );
+        }
+    }
+
+    unique_ptr< TransitionInstance > MapTransition::instantiate() const
+    {
+        return unique_ptr< TransitionInstance >( new TransitionInstanceImpl< MapTransition >( *this ) );
+    }
+
+    void MapTransition::transform( Connection& connection, ChannelBuffer& values ) const
+    {
+        ChannelBuffer const& input = values;
+        ChannelBuffer output( table_.size() );
+        std::transform( table_.cbegin(), table_.cend(), output.begin(), [&input]( size_t source ) {
+            return source != unmapped ? input[ source ] : ChannelValue();
+        } );
+        values = move( output );
+    }
+
+    bool MapTransition::fuse( size_t channels, FusionKernel& kernel ) const
+    {
+        kernel.gather( table_ );
+        return true;
+    }
+
+    static TransitionRegistry< MapTransition > registry( "map" );
+
+} // namespace sc
@@ -0,0 +1,47 @@
+#ifndef SCHLAZICONTROL_TRANSITION_MAP_HPP
+#define SCHLAZICONTROL_TRANSITION_MAP_HPP
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "transition.hpp"
+
+namespace sc {
+
+    class Manager;
+    class PropertyNode;
+
+    /**
+     * class MapTransition
+     *
+     * Remaps pixels from logical (rendering) order into physical (wiring) order. The layout is compiled into a
+     * gather table holding one source channel per output channel, so the remap is a single pass over the output.
+     */
+
+    class MapTransition final
+            : public Transition
+    {
+    public:
+        static constexpr std::size_t unmapped = std::numeric_limits< std::size_t >::max();
+
+        MapTransition( std::string&& id, Manager& manager, PropertyNode const& properties );
+
+        virtual std::unique_ptr< TransitionInstance > instantiate() const override;
+
+        bool acceptsChannels( std::size_t channels ) const { return channels >= requiredChannels_; }
+        std::size_t emitsChannels( std::size_t channels ) const { return table_.size(); }
+
+        void transform( Connection& connection, ChannelBuffer& values ) const;
+        bool fuse( std::size_t channels, FusionKernel& kernel ) const;
+        bool concurrent() const { return true; }
+
+    private:
+        std::vector< std::size_t > table_;
+        std::size_t requiredChannels_;
+    };
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_TRANSITION_MAP_HPP
@@ -2,6 +2,7 @@
 #include <utility>
 
 #include "core/properties.hpp"
+#include "fusion.hpp"
 #include "transition_multiply.hpp"
 #include "types.hpp"
 
@@ -31,6 +32,12 @@ namespace sc {
         values.multiply( factor_ );
     }
 
+    bool MultiplyTransition::fuse( size_t channels, FusionKernel& kernel ) const
+    {
+        kernel.repeat( factor_ );
+        return true;
+    }
+
     static TransitionRegistry< MultiplyTransition > registry( "multiply" );
 
 } // namespace sc
@@ -23,6 +23,8 @@ namespace sc {
         std::size_t emitsChannels( std::size_t channels ) const { return channels * factor_; }
 
         void transform( Connection& connection, ChannelBuffer& values ) const;
+        bool fuse( std::size_t channels, FusionKernel& kernel ) const;
+        bool concurrent() const { return true; }
 
     private:
         std::size_t factor_;
@@ -1,6 +1,7 @@
 #include <utility>
 
 #include "core/properties.hpp"
+#include "fusion.hpp"
 #include "transition_shift.hpp"
 #include "types.hpp"
 
@@ -26,6 +27,12 @@ namespace sc {
         values.shift( offset_ );
     }
 
+    bool ShiftTransition::fuse( size_t channels, FusionKernel& kernel ) const
+    {
+        kernel.shift( offset_ );
+        return true;
+    }
+
     static TransitionRegistry< ShiftTransition > registry( "shift" );
 
 } // namespace sc
@@ -24,6 +24,7 @@ namespace sc {
     static PropertyKey const eventProperty( "event" );
     static PropertyKey const outcomesProperty( "outcomes" );
     static PropertyKey const actionsProperty( "actions" );
+    static PropertyKey const perChannelProperty( "perChannel", false );
 
     struct ValueLimits
     {
@@ -37,11 +38,14 @@ namespace sc {
                     expression::Enumeration< string, typestring_is( "off" ), typestring_is( "on" ), typestring_is( "fullOn" ) >
             >
     {
-        ValueParser( intmax_t value ) : BaseType( { rangedPercent( value ) } ) {}
+        // a number as condition is a threshold, the input has to reach at least that value
+        ValueParser( intmax_t value ) : BaseType( number( rangedPercent( value ) ) ) {}
         ValueParser( string const& value ) : BaseType(
-                value == "off" ? Value { ChannelValue::offValue(), &ChannelValue::off } :
-                value == "on" ? Value { ChannelValue::fullOnValue(), &ChannelValue::on } :
-                Value { ChannelValue::fullOnValue(), &ChannelValue::fullOn } ) {}
+                value == "off" ? Value { ChannelValue::offValue(), Condition::exactly( ChannelValue::minimum ) } :
+                value == "on" ? Value { ChannelValue::fullOnValue(), Condition::above( ChannelValue::minimum ) } :
+                Value { ChannelValue::fullOnValue(), Condition::exactly( ChannelValue::maximum ) } ) {}
+
+        static Value number( ChannelValue const& value ) { return { value, Condition::atLeast( value.get() ) }; }
     };
 
     static unique_ptr< triggers::Event > parseEvent( PropertyNode const& event )
@@ -87,7 +91,8 @@ namespace sc {
     TriggersTransition::TriggersTransition( string&& id, Manager& manager, PropertyNode const& properties )
         : Transition( move( id ) )
         , manager_( manager )
-        , actions_( parseActions( properties[ actionsProperty ] ) )
+        , program_( parseActions( properties[ actionsProperty ] ), properties[ actionsProperty ].path() )
+        , perChannel_( properties[ perChannelProperty ].as< bool >() )
     {
     }
 
@@ -98,10 +103,27 @@ namespace sc {
 
     void TriggersTransition::transform( triggers::State& state, Connection& connection, ChannelBuffer& values ) const
     {
-        Context context { connection, manager_, state, values[ 0 ] };
-        for_each(
-                actions_.begin(), actions_.end(),
-                [&context]( triggers::Action const& action ) { action.invoke( context ); } );
+        auto channels = values.size();
+        if ( !state.timers || state.channels != channels ) {
+            program_.attach( state, manager_, connection, channels );
+        }
+
+        // only channels whose input moved to another zone or whose timers expired can fire actions
+        program_.classify( values, state.current.data() );
+        size_t changed = 0;
+        for ( size_t i = 0 ; i < channels ; ++i ) {
+            state.changed[ changed ] = (uint32_t) i;
+            changed += ( state.current[ i ] != state.zones[ i ] ) | ( state.expired[ i ] != 0 );
+        }
+
+        for_each( state.changed.begin(), state.changed.begin() + changed, [&]( uint32_t channel ) {
+            auto fired = program_.fired( state.zones[ channel ], state.current[ channel ], state.expired[ channel ] );
+            state.zones[ channel ] = state.current[ channel ];
+            state.expired[ channel ] = 0;
+            program_.run( fired, state.outputs[ channel ], state.timers.get(), channel );
+        } );
+
+        copy( state.outputs.begin(), state.outputs.end(), values.begin() );
     }
 
     static TransitionRegistry< TriggersTransition > registry( "triggers" );
@@ -1,11 +1,11 @@
 #ifndef SCHLAZICONTROL_TRANSITION_TRIGGERS_HPP
 #define SCHLAZICONTROL_TRANSITION_TRIGGERS_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
 #include "transition.hpp"
+#include "triggers.hpp"
 
 namespace sc {
 
@@ -13,10 +13,12 @@ namespace sc {
     class Manager;
     class PropertyNode;
 
-    namespace triggers {
-        class Action;
-        struct State;
-    } // namespace triggers
+    /**
+     * class TriggersTransition
+     *
+     * Runs a program of actions on the input, see triggers::Program. With perChannel, the program runs on every
+     * channel of the input independently, each channel with its own last input, output and timers.
+     */
 
     class TriggersTransition final
         : public Transition
@@ -26,14 +28,15 @@ namespace sc {
 
         virtual std::unique_ptr< TransitionInstance > instantiate() const override;
 
-        bool acceptsChannels( std::size_t channels ) const { return channels == 1; }
-        std::size_t emitsChannels( std::size_t channels ) const { return 1; }
+        bool acceptsChannels( std::size_t channels ) const { return perChannel_ || channels == 1; }
+        std::size_t emitsChannels( std::size_t channels ) const { return channels; }
 
         void transform( triggers::State& state, Connection& connection, ChannelBuffer& values ) const;
 
     private:
         Manager& manager_;
-        std::vector< triggers::Action > actions_;
+        triggers::Program program_;
+        bool perChannel_;
     };
 
 } // namespace sc
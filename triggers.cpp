@@ -1,9 +1,13 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <utility>
 
 #include "core/manager.hpp"
-#include "timer.hpp"
+#include "connection.hpp"
 #include "triggers.hpp"
+#include "utility_string.hpp"
 
 using namespace std;
 
@@ -11,19 +15,35 @@ namespace sc {
 
     namespace triggers {
 
-        /*
-         * class Value
+        static constexpr double infinity = numeric_limits< double >::infinity();
+
+        /**
+         * struct Condition
          */
 
-        Value::Value( ChannelValue const& value, function< bool ( ChannelValue const& other ) > condition )
-            : value_( value )
-            , condition_( move( condition ) )
+        Condition Condition::exactly( double value )
         {
+            return { nextafter( value, -infinity ), value };
         }
 
-        bool Value::matches( ChannelValue const& value ) const
+        Condition Condition::above( double value )
+        {
+            return { value, infinity };
+        }
+
+        Condition Condition::atLeast( double value )
+        {
+            return { nextafter( value, -infinity ), infinity };
+        }
+
+        /*
+         * class Value
+         */
+
+        Value::Value( ChannelValue const& value, Condition const& condition )
+            : value_( value )
+            , condition_( condition )
         {
-            return condition_( value );
         }
 
         /*
@@ -41,11 +61,9 @@ namespace sc {
         {
         }
 
-        bool ChangeEvent::applies( Context const& context ) const
+        void ChangeEvent::compile( Compiler& compiler ) const
         {
-            bool old = value_.matches( context.lastInput() );
-            bool current = value_.matches( context.input() );
-            return !old && current;
+            compiler.change( value_.condition() );
         }
 
         /*
@@ -57,9 +75,9 @@ namespace sc {
         {
         }
 
-        bool TimeoutEvent::applies( Context const& context ) const
+        void TimeoutEvent::compile( Compiler& compiler ) const
         {
-            return context.timerExpired( timer_ );
+            compiler.timeout( timer_ );
         }
 
         /*
@@ -77,9 +95,9 @@ namespace sc {
         {
         }
 
-        void SetOutcome::invoke( Context& context ) const
+        void SetOutcome::compile( Compiler& compiler ) const
         {
-            context.set( value_.get() );
+            compiler.set( value_.get() );
         }
 
         /*
@@ -92,9 +110,9 @@ namespace sc {
         {
         }
 
-        void StartTimerOutcome::invoke( Context& context ) const
+        void StartTimerOutcome::compile( Compiler& compiler ) const
         {
-            context.startTimer( timer_, timeout_ );
+            compiler.startTimer( timer_, timeout_ );
         }
 
         /*
@@ -106,9 +124,9 @@ namespace sc {
         {
         }
 
-        void StopTimerOutcome::invoke( Context& context ) const
+        void StopTimerOutcome::compile( Compiler& compiler ) const
         {
-            context.stopTimer( timer_ );
+            compiler.stopTimer( timer_ );
         }
 
         /**
@@ -121,60 +139,248 @@ namespace sc {
         {
         }
 
-        void Action::invoke( Context& context ) const
+        void Action::compile( Compiler& compiler ) const
         {
-            if ( event_->applies( context ) ) {
-                for_each(
-                        outcomes_.begin(), outcomes_.end(),
-                        [&]( unique_ptr< Outcome > const& outcome ) { outcome->invoke( context ); } );
+            event_->compile( compiler );
+            for_each(
+                    outcomes_.begin(), outcomes_.end(),
+                    [&]( unique_ptr< Outcome > const& outcome ) { outcome->compile( compiler ); } );
+        }
+
+        /**
+         * class TimerBatch
+         */
+
+        TimerBatch::TimerBatch()
+                : wheel_()
+                , connection_()
+                , expired_()
+                , bit_()
+                , pending_()
+                , armed_()
+        {
+        }
+
+        TimerBatch::~TimerBatch()
+        {
+            if ( wheel_ != nullptr ) {
+                wheel_->stop( *this );
             }
         }
 
+        void TimerBatch::attach( Manager& manager, Connection& connection, Mask* expired, size_t channels, size_t slot )
+        {
+            wheel_ = &manager.timerWheel();
+            connection_ = &connection;
+            expired_ = expired;
+            bit_ = Mask( 1 ) << slot;
+            deadlines_.assign( channels, Clock::time_point::max() );
+        }
+
+        void TimerBatch::start( size_t channel, chrono::nanoseconds timeout )
+        {
+            auto now = Clock::now();
+            auto& deadline = deadlines_[ channel ];
+            if ( deadline == Clock::time_point::max() ) {
+                ++pending_;
+            }
+            deadline = now + timeout;
+            if ( !running() || deadline < armed_ ) {
+                arm( now, deadline );
+            }
+        }
+
+        void TimerBatch::stop( size_t channel )
+        {
+            auto& deadline = deadlines_[ channel ];
+            if ( deadline == Clock::time_point::max() ) {
+                return;
+            }
+
+            // the wheel keeps the earliest deadline until it expires or no channel is left waiting
+            deadline = Clock::time_point::max();
+            if ( --pending_ == 0 ) {
+                wheel_->stop( *this );
+            }
+        }
+
+        void TimerBatch::expire()
+        {
+            auto now = Clock::now();
+            auto next = Clock::time_point::max();
+            auto due = false;
+            for ( size_t channel = 0 ; channel < deadlines_.size() ; ++channel ) {
+                auto& deadline = deadlines_[ channel ];
+                if ( deadline <= now ) {
+                    deadline = Clock::time_point::max();
+                    expired_[ channel ] |= bit_;
+                    --pending_;
+                    due = true;
+                }
+                else {
+                    next = min( next, deadline );
+                }
+            }
+
+            // starting the batch again from within the wheel is fine, the wheel doesn't run ahead of the tick it
+            // is expiring, so the next deadline can't land in the slot that is being emptied
+            if ( pending_ != 0 ) {
+                arm( now, next );
+            }
+            if ( due ) {
+                connection_->transfer();
+            }
+        }
+
+        void TimerBatch::arm( Clock::time_point now, Clock::time_point deadline )
+        {
+            armed_ = deadline;
+            wheel_->start( *this, deadline - now );
+        }
+
         /**
-         * class Context
+         * class Compiler
          */
 
-        Context::Context( Connection& connection, Manager& manager, State& state, ChannelValue& value )
-                : connection_( connection )
-                , manager_( manager )
-                , state_( state )
-                , value_( value )
+        void Compiler::change( Condition const& condition )
         {
+            actions_.push_back( { true, condition, 0, operations_.size() } );
         }
 
-        Context::~Context()
+        void Compiler::timeout( size_t timer )
         {
-            state_.lastInput = move( value_ );
-            value_ = state_.output;
+            actions_.push_back( { false, {}, slot( timer ), operations_.size() } );
         }
 
-        void Context::set( ChannelValue const& value )
+        void Compiler::set( ChannelValue const& value )
         {
-            state_.output = value;
+            operations_.push_back( { Code::set, 0, value, {} } );
         }
 
-        void Context::startTimer( size_t timer, chrono::nanoseconds const& timeout )
+        void Compiler::startTimer( size_t timer, chrono::nanoseconds const& timeout )
         {
-            Connection* connection = &connection_;
-            State* state = &state_;
-            auto it = state_.timers.emplace( timer, nullptr ).first;
-            it->second.reset( new Timer( manager_, timeout, [timer, connection, state, it] {
-                unique_ptr< Timer > ptr( move( it->second ) );
-                state->timers.erase( it );
+            operations_.push_back( { Code::startTimer, slot( timer ), {}, timeout } );
+        }
 
-                state->expiredTimers.insert( timer );
-                connection->transfer();
-            } ) );
+        void Compiler::stopTimer( size_t timer )
+        {
+            operations_.push_back( { Code::stopTimer, slot( timer ), {}, {} } );
         }
 
-        void Context::stopTimer( size_t timer )
+        size_t Compiler::slot( size_t timer )
         {
-            state_.timers.erase( timer );
+            // slots are numbered in the order the timers first appear
+            return slots_.emplace( timer, slots_.size() ).first->second;
         }
 
-        bool Context::timerExpired( size_t timer ) const
+        /**
+         * class Program
+         */
+
+        constexpr size_t Program::maxActions;
+        constexpr size_t Program::maxTimers;
+
+        Program::Program( vector< Action > const& actions, string const& path )
         {
-            return state_.expiredTimers.erase( timer ) > 0;
+            Compiler compiler;
+            for_each( actions.begin(), actions.end(), [&]( Action const& action ) { action.compile( compiler ); } );
+
+            if ( compiler.actions_.size() > maxActions ) {
+                throw runtime_error( str( "too many actions in ", path, ", at most ", maxActions, " are supported" ) );
+            }
+            if ( compiler.slots_.size() > maxTimers ) {
+                throw runtime_error( str( "too many timers in ", path, ", at most ", maxTimers, " are supported" ) );
+            }
+
+            for ( auto const& action : compiler.actions_ ) {
+                if ( action.change ) {
+                    thresholds_.push_back( action.condition.lower );
+                    thresholds_.push_back( action.condition.upper );
+                }
+            }
+            sort( thresholds_.begin(), thresholds_.end() );
+            thresholds_.erase( unique( thresholds_.begin(), thresholds_.end() ), thresholds_.end() );
+            zones_ = thresholds_.size() + 1;
+
+            // a value is above a threshold exactly if its zone is above the index of the threshold
+            auto index = [this]( double threshold ) {
+                return size_t( lower_bound( thresholds_.begin(), thresholds_.end(), threshold ) - thresholds_.begin() );
+            };
+
+            changes_.resize( zones_ * zones_ );
+            timeouts_.resize( compiler.slots_.size() );
+            for ( size_t i = 0 ; i < compiler.actions_.size() ; ++i ) {
+                auto const& action = compiler.actions_[ i ];
+                auto bit = Mask( 1 ) << i;
+                if ( action.change ) {
+                    auto lower = index( action.condition.lower );
+                    auto upper = index( action.condition.upper );
+                    auto matches = [=]( size_t zone ) { return zone > lower && zone <= upper; };
+                    for ( size_t from = 0 ; from < zones_ ; ++from ) {
+                        for ( size_t to = 0 ; to < zones_ ; ++to ) {
+                            if ( !matches( from ) && matches( to ) ) {
+                                changes_[ from * zones_ + to ] |= bit;
+                            }
+                        }
+                    }
+                }
+                // an expiry is consumed by the first action that waits for it, later ones never fire
+                else if ( timeouts_[ action.slot ] == 0 ) {
+                    timeouts_[ action.slot ] = bit;
+                }
+                actions_.push_back( action.first );
+            }
+            actions_.push_back( compiler.operations_.size() );
+            operations_ = move( compiler.operations_ );
+        }
+
+        void Program::classify( ChannelBuffer const& values, uint32_t* zones ) const
+        {
+            auto channels = values.size();
+            fill( zones, zones + channels, 0 );
+            for ( auto threshold : thresholds_ ) {
+                for ( size_t i = 0 ; i < channels ; ++i ) {
+                    zones[ i ] += values[ i ].get() > threshold;
+                }
+            }
+        }
+
+        void Program::run( Mask actions, ChannelValue& output, TimerBatch* timers, size_t channel ) const
+        {
+            for ( ; actions != 0 ; actions &= actions - 1 ) {
+                auto action = (size_t) __builtin_ctzll( actions );
+                for_each(
+                        operations_.begin() + actions_[ action ], operations_.begin() + actions_[ action + 1 ],
+                        [&]( Operation const& operation ) {
+                            switch ( operation.code ) {
+                                case Compiler::Code::set:
+                                    output = operation.value;
+                                    break;
+                                case Compiler::Code::startTimer:
+                                    timers[ operation.slot ].start( channel, operation.timeout );
+                                    break;
+                                case Compiler::Code::stopTimer:
+                                    timers[ operation.slot ].stop( channel );
+                                    break;
+                            }
+                        } );
+            }
+        }
+
+        void Program::attach( State& state, Manager& manager, Connection& connection, size_t channels ) const
+        {
+            auto zone = lower_bound( thresholds_.begin(), thresholds_.end(), ChannelValue().get() ) - thresholds_.begin();
+
+            state.channels = channels;
+            state.zones.assign( channels, (uint32_t) zone );
+            state.expired.assign( channels, 0 );
+            state.outputs.assign( channels, ChannelValue() );
+            state.current.resize( channels );
+            state.changed.resize( channels );
+            state.timers.reset( new TimerBatch[ timers() ] );
+            for ( size_t i = 0 ; i < timers() ; ++i ) {
+                state.timers[ i ].attach( manager, connection, state.expired.data(), channels, i );
+            }
         }
 
     } // namespace triggers
@@ -2,24 +2,48 @@
 #define SCHLAZICONTROL_TRIGGERS_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <chrono>
-#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
-#include "timer.hpp"
+#include "core/timerwheel.hpp"
 #include "types.hpp"
-#include "connection.hpp"
 
 namespace sc {
 
+    class Connection;
     class Manager;
 
     namespace triggers {
 
-        class Context;
+        class Compiler;
+
+        /**
+         * A set of actions or timer slots, one bit each
+         */
+        using Mask = std::uint64_t;
+
+        /**
+         * struct Condition
+         *
+         * A range of channel values given by two thresholds, the value has to be above the first and at most the
+         * second.
+         */
+
+        struct Condition
+        {
+            static Condition exactly( double value );
+            static Condition above( double value );
+            static Condition atLeast( double value );
+
+            bool matches( double value ) const { return value > lower && value <= upper; }
+
+            double lower;
+            double upper;
+        };
 
         /*
          * class Value
@@ -28,14 +52,14 @@ namespace sc {
         class Value
         {
         public:
-            Value( ChannelValue const& value, std::function< bool ( ChannelValue const& ) > condition = nullptr );
+            Value( ChannelValue const& value, Condition const& condition );
 
             ChannelValue const& get() const { return value_; }
-            bool matches( ChannelValue const& value ) const;
+            Condition const& condition() const { return condition_; }
 
         private:
             ChannelValue value_;
-            std::function< bool ( ChannelValue const& ) > condition_;
+            Condition condition_;
         };
 
         /*
@@ -47,7 +71,7 @@ namespace sc {
         public:
             virtual ~Event();
 
-            virtual bool applies( Context const& context ) const = 0;
+            virtual void compile( Compiler& compiler ) const = 0;
         };
 
         /*
@@ -59,7 +83,7 @@ namespace sc {
         public:
             explicit ChangeEvent( Value value );
 
-            virtual bool applies( Context const& context ) const override;
+            virtual void compile( Compiler& compiler ) const override;
 
         private:
             Value value_;
@@ -74,7 +98,7 @@ namespace sc {
         public:
             explicit TimeoutEvent( std::size_t timer );
 
-            virtual bool applies( Context const& context ) const override;
+            virtual void compile( Compiler& compiler ) const override;
 
         private:
             std::size_t timer_;
@@ -88,7 +112,8 @@ namespace sc {
         {
         public:
             virtual ~Outcome();
-            virtual void invoke( Context& context ) const = 0;
+
+            virtual void compile( Compiler& compiler ) const = 0;
         };
 
         /*
@@ -100,7 +125,7 @@ namespace sc {
         public:
             explicit SetOutcome( Value value );
 
-            virtual void invoke( Context& context ) const override;
+            virtual void compile( Compiler& compiler ) const override;
 
         private:
             Value value_;
@@ -115,7 +140,7 @@ namespace sc {
         public:
             StartTimerOutcome( std::size_t timer, std::chrono::nanoseconds const& timeout );
 
-            virtual void invoke( Context& context ) const override;
+            virtual void compile( Compiler& compiler ) const override;
 
         private:
             std::size_t timer_;
@@ -131,7 +156,7 @@ namespace sc {
         public:
             explicit StopTimerOutcome( std::size_t timer );
 
-            virtual void invoke( Context& context ) const override;
+            virtual void compile( Compiler& compiler ) const override;
 
         private:
             std::size_t timer_;
@@ -146,49 +171,166 @@ namespace sc {
         public:
             Action( std::unique_ptr< Event >&& event, std::vector< std::unique_ptr< Outcome > >&& outcomes );
 
-            void invoke( Context& context ) const;
+            void compile( Compiler& compiler ) const;
 
         private:
             std::unique_ptr< Event > event_;
             std::vector< std::unique_ptr< Outcome > > outcomes_;
         };
 
+        /**
+         * class TimerBatch
+         *
+         * One timer of a triggers instance, for all of its channels. Every channel has a deadline of its own, but the
+         * batch is on the timer wheel only once, for the earliest of them. On expiry it marks all channels that are
+         * due in their expired timers and has the connection transfer again, once for all of them.
+         */
+
+        class TimerBatch final
+                : public Expirable
+        {
+        public:
+            TimerBatch();
+            ~TimerBatch();
+
+            void attach( Manager& manager, Connection& connection, Mask* expired, std::size_t channels,
+                         std::size_t slot );
+
+            void start( std::size_t channel, std::chrono::nanoseconds timeout );
+            void stop( std::size_t channel );
+
+        protected:
+            void expire() override;
+
+        private:
+            using Clock = TimerWheel::Clock;
+
+            void arm( Clock::time_point now, Clock::time_point deadline );
+
+            TimerWheel* wheel_;
+            Connection* connection_;
+            Mask* expired_;
+            Mask bit_;
+            std::vector< Clock::time_point > deadlines_;
+            std::size_t pending_;
+            Clock::time_point armed_;
+        };
+
         /**
          * struct State
+         *
+         * The state of all channels of a triggers instance, one array per field.
          */
 
         struct State
         {
-            ChannelValue lastInput;
-            ChannelValue output;
-            std::unordered_map< std::size_t, std::unique_ptr< Timer > > timers;
-            std::unordered_set< std::size_t > expiredTimers;
+            std::size_t channels;
+            std::vector< std::uint32_t > zones;
+            std::vector< Mask > expired;
+            std::vector< ChannelValue > outputs;
+            std::vector< std::uint32_t > current;
+            std::vector< std::uint32_t > changed;
+            std::unique_ptr< TimerBatch[] > timers;
         };
 
         /**
-         * class Context
+         * class Compiler
+         *
+         * Collects the events and outcomes of the actions, in the order of the configuration, and numbers the timers.
          */
 
-        class Context
+        class Compiler
         {
-        public:
-            Context( Connection& connection, Manager& manager, State& state, ChannelValue& value );
-            ~Context();
+            friend class Program;
 
-            ChannelValue const& input() const { return value_; }
-            ChannelValue const& lastInput() const { return state_.lastInput; }
+        public:
+            void change( Condition const& condition );
+            void timeout( std::size_t timer );
 
             void set( ChannelValue const& value );
-
             void startTimer( std::size_t timer, std::chrono::nanoseconds const& timeout );
             void stopTimer( std::size_t timer );
-            bool timerExpired( std::size_t timer ) const;
 
         private:
-            Connection& connection_;
-            Manager& manager_;
-            State& state_;
-            ChannelValue& value_;
+            enum class Code : std::uint8_t
+            {
+                set,
+                startTimer,
+                stopTimer
+            };
+
+            struct Operation
+            {
+                Code code;
+                std::size_t slot;
+                ChannelValue value;
+                std::chrono::nanoseconds timeout;
+            };
+
+            struct CompiledAction
+            {
+                bool change;
+                Condition condition;
+                std::size_t slot;
+                std::size_t first;
+            };
+
+            std::size_t slot( std::size_t timer );
+
+            std::vector< CompiledAction > actions_;
+            std::vector< Operation > operations_;
+            std::unordered_map< std::size_t, std::size_t > slots_;
+        };
+
+        /**
+         * class Program
+         *
+         * The actions of a triggers transition, compiled into tables. The thresholds of all conditions divide the
+         * channel values into zones, and a table indexed by the zones of the last and the current input holds the
+         * actions whose change event fires. Every timer has a fixed slot, which names the action its timeout fires.
+         * The outcomes of the fired actions run in the order of the configuration, from one flat list.
+         */
+
+        class Program
+        {
+        public:
+            static constexpr std::size_t maxActions = 64;
+            static constexpr std::size_t maxTimers = 64;
+
+            Program( std::vector< Action > const& actions, std::string const& path );
+
+            std::size_t timers() const { return timeouts_.size(); }
+
+            /**
+             * Stores the zones of all values, the loop over the channels runs once per threshold without branches
+             */
+            void classify( ChannelBuffer const& values, std::uint32_t* zones ) const;
+
+            Mask fired( std::size_t from, std::size_t to, Mask expired ) const
+            {
+                auto result = changes_[ from * zones_ + to ];
+                for ( ; expired != 0 ; expired &= expired - 1 ) {
+                    result |= timeouts_[ __builtin_ctzll( expired ) ];
+                }
+                return result;
+            }
+
+            void run( Mask actions, ChannelValue& output, TimerBatch* timers, std::size_t channel ) const;
+
+            /**
+             * Sets up the state for the number of channels, starting all of them over
+             */
+            void attach( State& state, Manager& manager, Connection& connection, std::size_t channels ) const;
+
+        private:
+            using Operation = Compiler::Operation;
+
+            std::vector< double > thresholds_;
+            std::size_t zones_;
+            std::vector< Mask > changes_;
+            std::vector< Mask > timeouts_;
+            std::vector< std::size_t > actions_;
+            std::vector< Operation > operations_;
         };
 
     } // namespace triggers
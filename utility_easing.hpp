@@ -0,0 +1,84 @@
+#ifndef SCHLAZICONTROL_UTILITY_EASING_HPP
+#define SCHLAZICONTROL_UTILITY_EASING_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "utility_valuetable.hpp"
+
+namespace sc {
+
+	namespace detail {
+
+		static constexpr std::size_t easingSteps = 256;
+
+		template< typename Curve >
+		struct EasingFunction
+		{
+			static std::uint16_t constexpr const max = std::numeric_limits< std::uint16_t >::max();
+
+			static std::uint16_t constexpr apply( std::size_t input )
+			{
+				return (std::uint16_t) ( Curve::apply( (double) input / easingSteps ) * max + 0.5 );
+			}
+		};
+
+		struct EaseInCurve
+		{
+			static double constexpr apply( double x ) { return x * x * x; }
+		};
+
+		struct EaseOutCurve
+		{
+			static double constexpr apply( double x ) { return 1.0 - ( 1.0 - x ) * ( 1.0 - x ) * ( 1.0 - x ); }
+		};
+
+		struct EaseInOutCurve
+		{
+			static double constexpr apply( double x )
+			{
+				return x < 0.5 ? 4.0 * x * x * x : 1.0 - 4.0 * ( 1.0 - x ) * ( 1.0 - x ) * ( 1.0 - x );
+			}
+		};
+
+		struct ExponentialCurve
+		{
+			static double constexpr apply( double x )
+			{
+				return ( std::pow( 2.0, 10.0 * ( x - 1.0 ) ) - std::pow( 2.0, -10.0 ) ) / ( 1.0 - std::pow( 2.0, -10.0 ) );
+			}
+		};
+
+	} // namespace detail
+
+	/**
+	 * struct EasingTable
+	 *
+	 * Evaluates an easing curve for a progress of 0..1 from a table precomputed at compile time, interpolating
+	 * linearly between the table entries.
+	 */
+
+	template< typename Curve >
+	struct EasingTable
+	{
+		static double get( double progress )
+		{
+			using Table = ValueTable< detail::EasingFunction< Curve >, 0, detail::easingSteps >;
+
+			auto position = progress * detail::easingSteps;
+			auto index = (std::size_t) position;
+			if ( index >= detail::easingSteps ) {
+				return 1.0;
+			}
+			auto fraction = position - index;
+			auto a = Table::get( index );
+			auto b = Table::get( index + 1 );
+			return ( a + ( b - a ) * fraction ) / detail::EasingFunction< Curve >::max;
+		}
+	};
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_UTILITY_EASING_HPP
@@ -0,0 +1,192 @@
+#ifndef SCHLAZICONTROL_UTILITY_FUNCTION_HPP
+#define SCHLAZICONTROL_UTILITY_FUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sc {
+
+    namespace detail {
+
+        template< typename... > struct VoidType { using type = void; };
+
+        template< typename Function, typename Signature, typename = void >
+        struct IsCallable : std::false_type {};
+
+        template< typename Function, typename Result, typename... Args >
+        struct IsCallable<
+                Function, Result ( Args... ),
+                typename VoidType< decltype( std::declval< Function >()( std::declval< Args >()... ) ) >::type >
+                : std::integral_constant<
+                        bool,
+                        std::is_void< Result >::value
+                        || std::is_convertible<
+                                decltype( std::declval< Function >()( std::declval< Args >()... ) ), Result >::value >
+        {
+        };
+
+    } // namespace detail
+
+    template< typename Function, typename Signature >
+    using IsCallable = detail::IsCallable< Function, Signature >;
+
+    /**
+     * class InlineFunction
+     *
+     * A move-only replacement for std::function that stores callables of up to Capacity bytes in place. Larger ones
+     * are allocated once on construction, calling never allocates.
+     */
+
+    template< typename Signature, std::size_t Capacity = 4 * sizeof( void* ) >
+    class InlineFunction;
+
+    template< typename Result, typename... Args, std::size_t Capacity >
+    class InlineFunction< Result ( Args... ), Capacity >
+    {
+        using Storage = std::aligned_storage_t< Capacity, alignof( std::max_align_t ) >;
+
+        struct Operations
+        {
+            Result ( *invoke )( Storage& storage, Args... args );
+            void ( *move )( Storage& from, Storage& to );
+            void ( *destroy )( Storage& storage );
+        };
+
+        template< typename Function >
+        struct Inline
+        {
+            static Function& get( Storage& storage ) { return *reinterpret_cast< Function* >( &storage ); }
+
+            static Result invoke( Storage& storage, Args... args ) { return get( storage )( std::forward< Args >( args )... ); }
+
+            static void move( Storage& from, Storage& to )
+            {
+                new ( &to ) Function( std::move( get( from ) ) );
+                get( from ).~Function();
+            }
+
+            static void destroy( Storage& storage ) { get( storage ).~Function(); }
+
+            static constexpr Operations operations { &invoke, &move, &destroy };
+        };
+
+        template< typename Function >
+        struct Allocated
+        {
+            static Function*& get( Storage& storage ) { return *reinterpret_cast< Function** >( &storage ); }
+
+            static Result invoke( Storage& storage, Args... args ) { return ( *get( storage ) )( std::forward< Args >( args )... ); }
+
+            static void move( Storage& from, Storage& to ) { new ( &to ) Function*( get( from ) ); }
+
+            static void destroy( Storage& storage ) { delete get( storage ); }
+
+            static constexpr Operations operations { &invoke, &move, &destroy };
+        };
+
+        template< typename Function >
+        using FitsInline = std::integral_constant<
+                bool,
+                sizeof( Function ) <= Capacity && alignof( Function ) <= alignof( Storage )
+                && std::is_nothrow_move_constructible< Function >::value >;
+
+    public:
+        InlineFunction() noexcept = default;
+        InlineFunction( std::nullptr_t ) noexcept {}
+
+        template<
+                typename Function,
+                typename = std::enable_if_t<
+                        !std::is_same< std::decay_t< Function >, InlineFunction >::value
+                        && IsCallable< std::decay_t< Function >&, Result ( Args... ) >::value > >
+        InlineFunction( Function&& function )
+        {
+            construct< std::decay_t< Function > >(
+                    std::forward< Function >( function ), FitsInline< std::decay_t< Function > >() );
+        }
+
+        InlineFunction( InlineFunction&& other ) noexcept
+        {
+            assign( std::move( other ) );
+        }
+
+        InlineFunction( InlineFunction const& ) = delete;
+
+        ~InlineFunction()
+        {
+            reset();
+        }
+
+        InlineFunction& operator=( InlineFunction&& other ) noexcept
+        {
+            if ( this != &other ) {
+                reset();
+                assign( std::move( other ) );
+            }
+            return *this;
+        }
+
+        InlineFunction& operator=( std::nullptr_t ) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        explicit operator bool() const { return operations_ != nullptr; }
+
+        Result operator()( Args... args ) const
+        {
+            return operations_->invoke( storage_, std::forward< Args >( args )... );
+        }
+
+    private:
+        template< typename Function, typename Argument >
+        void construct( Argument&& function, std::true_type )
+        {
+            new ( &storage_ ) Function( std::forward< Argument >( function ) );
+            operations_ = &Inline< Function >::operations;
+        }
+
+        template< typename Function, typename Argument >
+        void construct( Argument&& function, std::false_type )
+        {
+            new ( &storage_ ) Function*( new Function( std::forward< Argument >( function ) ) );
+            operations_ = &Allocated< Function >::operations;
+        }
+
+        void assign( InlineFunction&& other ) noexcept
+        {
+            if ( other.operations_ ) {
+                other.operations_->move( other.storage_, storage_ );
+                operations_ = other.operations_;
+                other.operations_ = nullptr;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if ( operations_ ) {
+                operations_->destroy( storage_ );
+                operations_ = nullptr;
+            }
+        }
+
+        mutable Storage storage_;
+        Operations const* operations_ {};
+    };
+
+    template< typename Result, typename... Args, std::size_t Capacity >
+    template< typename Function >
+    constexpr typename InlineFunction< Result ( Args... ), Capacity >::Operations
+            InlineFunction< Result ( Args... ), Capacity >::Inline< Function >::operations;
+
+    template< typename Result, typename... Args, std::size_t Capacity >
+    template< typename Function >
+    constexpr typename InlineFunction< Result ( Args... ), Capacity >::Operations
+            InlineFunction< Result ( Args... ), Capacity >::Allocated< Function >::operations;
+
+} // namespace sc
+
+#endif // SCHLAZICONTROL_UTILITY_FUNCTION_HPP